@@ -1,6 +1,7 @@
 #pragma once
 
 #include "generalizedassignmentsolver/solution.hpp"
+#include "generalizedassignmentsolver/algorithms/reduced_cost_fixing.hpp"
 
 namespace generalizedassignmentsolver
 {
@@ -9,6 +10,28 @@ struct ColumnGenerationParameters: Parameters
 {
     std::string linear_programming_solver = "CLP";
 
+    /**
+     * Reduced cost fixing of the instance; if not 'nullptr', the column
+     * generation is run on its restricted instance.
+     */
+    const ReducedCostFixingOutput* reduced_cost_fixing = nullptr;
+
+    /**
+     * Initial solution of the instance; it is reported, and its columns are
+     * added to the initial restricted master problem. With reduced cost
+     * fixing, the columns are only added if the solution is feasible for
+     * the restricted instance.
+     */
+    const Solution* initial_solution = nullptr;
+
+    /**
+     * Initial duals of the instance, agent rows first; the columns of the
+     * pricing problem for these duals are added to the initial restricted
+     * master problem. With reduced cost fixing, the duals of the fixed items
+     * are dropped.
+     */
+    const std::vector<double>* initial_duals = nullptr;
+
 
     virtual int format_width() const override { return 28; }
 
@@ -18,7 +41,16 @@ struct ColumnGenerationParameters: Parameters
         int width = format_width();
         os
             << std::setw(width) << std::left << "Linear programming solver: " << linear_programming_solver << std::endl
+            << std::setw(width) << std::left << "Reduced cost fixing: " << (reduced_cost_fixing != nullptr) << std::endl
+            << std::setw(width) << std::left << "Has initial solution: " << (initial_solution != nullptr) << std::endl
+            << std::setw(width) << std::left << "Has initial duals: " << (initial_duals != nullptr) << std::endl
             ;
+        if (reduced_cost_fixing != nullptr) {
+            os
+                << std::setw(width) << std::left << "Removed alternatives: " << reduced_cost_fixing->number_of_removed_alternatives << std::endl
+                << std::setw(width) << std::left << "Fixed items: " << reduced_cost_fixing->number_of_fixed_items << std::endl
+                ;
+        }
     }
 
     virtual nlohmann::json to_json() const override
@@ -26,6 +58,10 @@ struct ColumnGenerationParameters: Parameters
         nlohmann::json json = Parameters::to_json();
         json.merge_patch({
                 {"LinearProgrammingSolver", linear_programming_solver},
+                {"ReducedCostFixing", (reduced_cost_fixing != nullptr)?
+                    reduced_cost_fixing->to_json(): nlohmann::json(false)},
+                {"HasInitialSolution", (initial_solution != nullptr)},
+                {"HasInitialDuals", (initial_duals != nullptr)},
                 });
         return json;
     }
@@ -44,6 +80,9 @@ struct ColumnGenerationOutput: Output
 
     Counter number_of_added_columns = 0;
 
+    /** Duals of the last pricing problem, agent rows first. */
+    std::vector<double> dual_solution;
+
 
     virtual void format(std::ostream& os) const override
     {
@@ -49,6 +49,133 @@ const Output mthg_regret(
         const Instance& instance,
         const GreedyParameters& parameters = {});
 
+struct GreedyPortfolioParameters: Parameters
+{
+    /** Number of threads. */
+    Counter number_of_threads = 1;
+
+
+    virtual int format_width() const override { return 26; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                });
+        return json;
+    }
+};
+
+/**
+ * Run greedy, greedy-regret, mthg and mthg-regret with every desirability
+ * and return the best solution found.
+ *
+ * The sorted orders are computed once per desirability and shared by the
+ * runs. Runs are distributed among 'number_of_threads' threads.
+ */
+const Output greedy_portfolio(
+        const Instance& instance,
+        const GreedyPortfolioParameters& parameters = {});
+
+struct GraspParameters: GreedyParameters
+{
+    /** Construction algorithm: "greedy" or "greedy-regret". */
+    std::string construction = "greedy-regret";
+
+    /** Size of the restricted candidate list. */
+    Counter restricted_candidate_list_size = 3;
+
+    /** Maximum number of iterations. */
+    Counter maximum_number_of_iterations = 1000;
+
+    /** Number of threads. */
+    Counter number_of_threads = 1;
+
+    /** Seed. */
+    Seed seed = 0;
+
+
+    virtual int format_width() const override { return 32; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        GreedyParameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Construction: " << construction << std::endl
+            << std::setw(width) << std::left << "Restricted candidate list size: " << restricted_candidate_list_size << std::endl
+            << std::setw(width) << std::left << "Maximum number of iterations: " << maximum_number_of_iterations << std::endl
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Seed: " << seed << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = GreedyParameters::to_json();
+        json.merge_patch({
+                {"Construction", construction},
+                {"RestrictedCandidateListSize", restricted_candidate_list_size},
+                {"MaximumNumberOfIterations", maximum_number_of_iterations},
+                {"NumberOfThreads", number_of_threads},
+                {"Seed", seed},
+                });
+        return json;
+    }
+};
+
+struct GraspOutput: Output
+{
+    GraspOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /** Number of iterations. */
+    Counter number_of_iterations = 0;
+
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of iterations: " << number_of_iterations << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfIterations", number_of_iterations}});
+        return json;
+    }
+};
+
+/**
+ * Greedy randomized adaptive search procedure.
+ *
+ * At each step of the construction, the next assignment is drawn uniformly
+ * among the 'restricted_candidate_list_size' best candidates of the
+ * corresponding greedy algorithm. Each constructed solution is then improved
+ * with the shift procedure of MTHG. Iterations are distributed among
+ * 'number_of_threads' threads, each with its own random stream.
+ */
+const GraspOutput grasp(
+        const Instance& instance,
+        const GraspParameters& parameters = {});
+
 // These additional functions can be used to fill a partial solutions.
 //
 // auto aternatives = greedy_init(instance, f);
@@ -88,4 +215,105 @@ void mthg_regret(
         const std::vector<std::vector<AgentIdx>>& agents,
         const std::vector<std::vector<int>>& fixed_alternatives = {});
 
+/**
+ * Round a fractional solution 'x[item_id][agent_id]', for example the
+ * solution of a relaxation, into a solution.
+ *
+ * Items are assigned by MTHG-regret with '-x[item_id][agent_id]' as
+ * desirability, ties being broken by costs: the items whose fractional
+ * assignment is the most decided are assigned first, to the agent with the
+ * largest value if it fits.
+ */
+Solution round_fractional_solution(
+        const Instance& instance,
+        const std::vector<std::vector<double>>& x);
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////// Greedy repair /////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Changes from a previous instance to a new instance.
+ *
+ * The items of the new instance are the items of the previous instance which
+ * have not been removed, in the same order, followed by the new items.
+ */
+struct InstanceDelta
+{
+    /** Ids, in the previous instance, of the removed items. */
+    std::vector<ItemIdx> removed_items;
+
+    /** Number of new items, added at the end of the new instance. */
+    ItemIdx number_of_new_items = 0;
+
+    /** Agents whose capacity has changed. */
+    std::vector<AgentIdx> modified_capacities;
+
+    /**
+     * Ids, in the new instance, of the remaining items whose weights or
+     * costs have changed.
+     */
+    std::vector<ItemIdx> modified_items;
+};
+
+/**
+ * Desirabilities and sorted agents used by the greedy repair.
+ *
+ * They are computed once by 'greedy_repair_init' and then updated
+ * incrementally by 'greedy_repair'.
+ */
+struct GreedyRepairData
+{
+    /** Desirability name. */
+    std::string desirability_name;
+
+    /** Desirabilities of the items of the current instance. */
+    std::vector<std::vector<double>> desirability;
+
+    /** For each item, agents sorted by desirability. */
+    std::vector<std::vector<AgentIdx>> agents;
+};
+
+GreedyRepairData greedy_repair_init(
+        const Instance& instance,
+        const std::string& desirability);
+
+/**
+ * Repair a solution of a previous instance into a solution of a new
+ * instance.
+ *
+ * Assignments of the items which remain and have not been modified are
+ * kept. Then, for each agent whose capacity is exceeded, its least desirable
+ * items are unassigned until it fits. Finally, unassigned and new items are
+ * inserted with greedy_regret.
+ *
+ * 'data' must correspond to the previous instance; it is updated to
+ * correspond to the new instance. Only the rows of the new and of the
+ * modified items are computed, except for the "wij/ti" desirability, for
+ * which the columns of the agents whose capacity has changed are also
+ * updated.
+ */
+Solution greedy_repair(
+        const Instance& instance,
+        const Solution& previous_solution,
+        const InstanceDelta& delta,
+        GreedyRepairData& data);
+
+/**
+ * Repair a solution of a previous instance into a solution of a new
+ * instance with the same agents.
+ *
+ * The items of the new instance are assumed to be the first items of the
+ * previous instance, followed by the new items. The agents whose capacity
+ * has changed and the items whose weights or costs have changed are
+ * detected by comparing both instances.
+ *
+ * With an empty previous solution of the same instance, the result is the
+ * solution of greedy_regret.
+ */
+const Output greedy_repair(
+        const Instance& instance,
+        const Solution& previous_solution,
+        const GreedyParameters& parameters = {});
+
 }
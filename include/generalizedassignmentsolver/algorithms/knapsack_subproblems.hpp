@@ -0,0 +1,93 @@
+#pragma once
+
+#include "generalizedassignmentsolver/instance.hpp"
+
+#include <functional>
+
+namespace generalizedassignmentsolver
+{
+
+/**
+ * Knapsack subproblems of the agents.
+ *
+ * The Lagrangian relaxation of the assignment constraints and the pricing
+ * problem of the column generation both decompose into one knapsack problem
+ * per agent, in which the profit of an item is
+ * 'item_values[item_id] - c(item_id, agent_id)' for some values associated to
+ * the items (multipliers or duals).
+ *
+ * For each agent, the items which may be selected are computed once and the
+ * buffers are kept between the calls to 'solve'. The knapsack instance and
+ * the solver output can't be reused: knapsacksolver builds a new instance
+ * from a builder, and its algorithms return a new output, at each call. Thus,
+ * each call to 'solve' still allocates memory. The subproblems of different
+ * agents may be solved concurrently.
+ */
+class KnapsackSubproblems
+{
+
+public:
+
+    /** Constructor. */
+    KnapsackSubproblems(const Instance& instance);
+
+    /**
+     * Set the capacity of the subproblem of an agent and the items which
+     * can't be selected.
+     *
+     * By default, the capacity is the capacity of the agent and all items
+     * can be selected.
+     */
+    void set_subproblem(
+            AgentIdx agent_id,
+            Weight capacity,
+            const std::function<bool (ItemIdx)>& excluded_items);
+
+    /**
+     * Solve the knapsack subproblem of an agent.
+     *
+     * The profit of an item is
+     * 'item_values[item_values_offset + item_id] - c(item_id, agent_id)';
+     * only the items with a positive profit are considered.
+     *
+     * Return the selected items. The vector is overwritten by the next call
+     * for the same agent.
+     */
+    const std::vector<ItemIdx>& solve(
+            AgentIdx agent_id,
+            const std::vector<double>& item_values,
+            ItemIdx item_values_offset = 0);
+
+    /** Get the items selected in the last solution of the subproblem of an agent. */
+    const std::vector<ItemIdx>& selected_items(AgentIdx agent_id) const { return subproblems_[agent_id].selected_items; }
+
+private:
+
+    /** Buffers of the subproblem of an agent. */
+    struct AgentSubproblem
+    {
+        /** Capacity. */
+        Weight capacity = 0;
+
+        /** Items which may be selected. */
+        std::vector<ItemIdx> items;
+
+        /** Items of the last knapsack instance built. */
+        std::vector<ItemIdx> kp_to_gap;
+
+        /** Items selected in the last solution. */
+        std::vector<ItemIdx> selected_items;
+    };
+
+    /** Reserve the buffers of an agent for its current items. */
+    void reserve(AgentSubproblem& subproblem);
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Subproblems of the agents. */
+    std::vector<AgentSubproblem> subproblems_;
+
+};
+
+}
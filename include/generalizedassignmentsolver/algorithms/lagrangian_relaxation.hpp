@@ -7,28 +7,155 @@
 namespace generalizedassignmentsolver
 {
 
-////////////////////////////////////////////////////////////////////////////////
-//////////////////////// lagrangian_relaxation_assignment //////////////////////
-////////////////////////////////////////////////////////////////////////////////
-
-struct LagrangianRelaxationAssignmentParameters: Parameters
+struct LagrangianRelaxationParameters: Parameters
 {
-    /** Solver. */
+    /**
+     * Optimizer of the Lagrangian dual:
+     * - 'subgradient': subgradient method with Polyak steps towards a target
+     *   value which is updated during the search
+     * - 'bundle': proximal bundle method
+     * - 'solver': external solver 'solver' (Knitro, dlib or ConicBundle)
+     *
+     * The subgradient and bundle methods don't require any external solver.
+     */
+    std::string dual_optimizer = "bundle";
+
+    /** Solver, if 'dual_optimizer' is 'solver'. */
     mathoptsolverscmake::SolverName solver = mathoptsolverscmake::SolverName::Dlib;
+
+    /**
+     * Maximum number of evaluations of the dual function of the subgradient
+     * and bundle methods.
+     */
+    Counter maximum_number_of_iterations = -1;
+
+    /**
+     * Maximum number of consecutive evaluations of the dual function without
+     * improving the bound in the subgradient and bundle methods.
+     */
+    Counter maximum_number_of_iterations_without_improvement = 200;
+
+    /**
+     * Run a Lagrangian heuristic after the evaluations of the dual function
+     * which improve its best value, to build primal solutions from the
+     * solutions of the relaxation.
+     *
+     * Not available with fixed alternatives.
+     */
+    bool lagrangian_heuristic = false;
+
+
+    virtual int format_width() const override { return 46; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Dual optimizer: " << dual_optimizer << std::endl
+            << std::setw(width) << std::left << "Maximum number of iterations: " << maximum_number_of_iterations << std::endl
+            << std::setw(width) << std::left << "Maximum number of iterations w/o improvement: " << maximum_number_of_iterations_without_improvement << std::endl
+            << std::setw(width) << std::left << "Lagrangian heuristic: " << lagrangian_heuristic << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"DualOptimizer", dual_optimizer},
+                {"MaximumNumberOfIterations", maximum_number_of_iterations},
+                {"MaximumNumberOfIterationsWithoutImprovement", maximum_number_of_iterations_without_improvement},
+                {"LagrangianHeuristic", lagrangian_heuristic},
+                });
+        return json;
+    }
 };
 
-struct LagrangianRelaxationAssignmentOutput: Output
+struct LagrangianRelaxationOutput: Output
 {
-    LagrangianRelaxationAssignmentOutput(
+    LagrangianRelaxationOutput(
             const Instance& instance):
         Output(instance) { }
 
 
-    /** vector of size instance.alternative_number(). */
+    /**
+     * Ergodic average of the solutions of the subproblems:
+     * 'x[item_id][agent_id]'.
+     */
     std::vector<std::vector<double>> x;
 
-    /** vector of size instance.number_of_items() */
+    /** Multipliers of the best bound. */
     std::vector<double> multipliers;
+
+    /** Number of evaluations of the dual function. */
+    Counter number_of_iterations = 0;
+
+    /** Number of calls to the Lagrangian heuristic. */
+    Counter number_of_lagrangian_heuristic_calls = 0;
+
+
+    virtual int format_width() const override { return 37; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of iterations: " << number_of_iterations << std::endl
+            << std::setw(width) << std::left << "Number of Lagrangian heuristic calls: " << number_of_lagrangian_heuristic_calls << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfIterations", number_of_iterations},
+                {"NumberOfLagrangianHeuristicCalls", number_of_lagrangian_heuristic_calls}});
+        return json;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////// lagrangian_relaxation_assignment //////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+struct LagrangianRelaxationAssignmentParameters: LagrangianRelaxationParameters
+{
+    /**
+     * Number of threads used to solve the knapsack subproblems of each
+     * evaluation of the dual function.
+     *
+     * The bound and the gradient don't depend on the number of threads.
+     */
+    Counter number_of_threads = 1;
+
+
+    virtual void format(std::ostream& os) const override
+    {
+        LagrangianRelaxationParameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = LagrangianRelaxationParameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                });
+        return json;
+    }
+};
+
+struct LagrangianRelaxationAssignmentOutput: LagrangianRelaxationOutput
+{
+    LagrangianRelaxationAssignmentOutput(
+            const Instance& instance):
+        LagrangianRelaxationOutput(instance) { }
 };
 
 const LagrangianRelaxationAssignmentOutput lagrangian_relaxation_assignment(
@@ -41,23 +168,40 @@ const LagrangianRelaxationAssignmentOutput lagrangian_relaxation_assignment(
 ////////////////////////// lagrangian_relaxation_knapsack //////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
-struct LagrangianRelaxationKnapsackParameters: Parameters
+struct LagrangianRelaxationKnapsackParameters: LagrangianRelaxationParameters
 {
-    /** Solver. */
-    mathoptsolverscmake::SolverName solver = mathoptsolverscmake::SolverName::Dlib;
+    /**
+     * Number of threads used to evaluate the dual function.
+     *
+     * The bound and the gradient don't depend on the number of threads.
+     */
+    Counter number_of_threads = 1;
+
+
+    virtual void format(std::ostream& os) const override
+    {
+        LagrangianRelaxationParameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = LagrangianRelaxationParameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                });
+        return json;
+    }
 };
 
-struct LagrangianRelaxationKnapsackOutput: Output
+struct LagrangianRelaxationKnapsackOutput: LagrangianRelaxationOutput
 {
     LagrangianRelaxationKnapsackOutput(
             const Instance& instance):
-        Output(instance) { }
-
-    /** vector of size instance.alternative_number(). */
-    std::vector<std::vector<double>> x;
-
-    /** vector of size instance.number_of_items() */
-    std::vector<double> multipliers;
+        LagrangianRelaxationOutput(instance) { }
 };
 
 const LagrangianRelaxationKnapsackOutput lagrangian_relaxation_knapsack(
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "generalizedassignmentsolver/solution.hpp"
+
+#include "mathoptsolverscmake/mathopt.hpp"
+
+namespace generalizedassignmentsolver
+{
+
+struct LargeNeighborhoodSearchParameters: Parameters
+{
+    /** Number of threads. */
+    Counter number_of_threads = 1;
+
+    /** Maximum number of iterations, summed over all threads. */
+    Counter maximum_number_of_iterations = -1;
+
+    /** Minimum number of items removed by a destroy operator. */
+    ItemIdx minimum_number_of_removed_items = 5;
+
+    /** Maximum number of items removed by a destroy operator. */
+    ItemIdx maximum_number_of_removed_items = 30;
+
+    /**
+     * Use the MILP repair operator in addition to the greedy-regret repair
+     * operator.
+     */
+    bool milp_repair = false;
+
+    /** Solver of the MILP repair operator. */
+    mathoptsolverscmake::SolverName solver = mathoptsolverscmake::SolverName::Highs;
+
+    /** Time limit of each call to the MILP repair operator. */
+    double milp_repair_time_limit = 1.0;
+
+    /**
+     * Number of iterations of a thread between two updates of the weights of
+     * the operators.
+     */
+    Counter segment_length = 100;
+
+    /**
+     * Reaction factor of the adaptive operator selection.
+     *
+     * At the end of each segment, the weight of an operator becomes
+     * '(1 - reaction_factor) * weight + reaction_factor * average_score'.
+     */
+    double reaction_factor = 0.2;
+
+    /** Seed; thread 'i' uses 'seed + i'. */
+    Seed seed = 0;
+
+    /** Initial solution. */
+    const Solution* initial_solution = nullptr;
+
+
+    virtual int format_width() const override { return 34; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Maximum number of iterations: " << maximum_number_of_iterations << std::endl
+            << std::setw(width) << std::left << "Minimum number of removed items: " << minimum_number_of_removed_items << std::endl
+            << std::setw(width) << std::left << "Maximum number of removed items: " << maximum_number_of_removed_items << std::endl
+            << std::setw(width) << std::left << "MILP repair: " << milp_repair << std::endl
+            << std::setw(width) << std::left << "MILP repair time limit: " << milp_repair_time_limit << std::endl
+            << std::setw(width) << std::left << "Segment length: " << segment_length << std::endl
+            << std::setw(width) << std::left << "Reaction factor: " << reaction_factor << std::endl
+            << std::setw(width) << std::left << "Seed: " << seed << std::endl
+            << std::setw(width) << std::left << "Has initial solution: " << (initial_solution != nullptr) << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                {"MaximumNumberOfIterations", maximum_number_of_iterations},
+                {"MinimumNumberOfRemovedItems", minimum_number_of_removed_items},
+                {"MaximumNumberOfRemovedItems", maximum_number_of_removed_items},
+                {"MilpRepair", milp_repair},
+                {"MilpRepairTimeLimit", milp_repair_time_limit},
+                {"SegmentLength", segment_length},
+                {"ReactionFactor", reaction_factor},
+                {"Seed", seed},
+                {"HasInitialSolution", (initial_solution != nullptr)},
+                });
+        return json;
+    }
+};
+
+struct LargeNeighborhoodSearchOutput: Output
+{
+    LargeNeighborhoodSearchOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /** Number of iterations. */
+    Counter number_of_iterations = 0;
+
+    /**
+     * Number of uses of each destroy operator: agent subset, related items
+     * and random items.
+     */
+    std::vector<Counter> destroy_operators_number_of_uses;
+
+    /**
+     * Number of uses of each repair operator: greedy-regret, and MILP if
+     * enabled.
+     */
+    std::vector<Counter> repair_operators_number_of_uses;
+
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of iterations: " << number_of_iterations << std::endl
+            ;
+        for (Counter operator_id = 0;
+                operator_id < (Counter)destroy_operators_number_of_uses.size();
+                ++operator_id) {
+            os
+                << std::setw(width) << std::left << "Destroy operator " + std::to_string(operator_id) + ": "
+                << destroy_operators_number_of_uses[operator_id] << std::endl
+                ;
+        }
+        for (Counter operator_id = 0;
+                operator_id < (Counter)repair_operators_number_of_uses.size();
+                ++operator_id) {
+            os
+                << std::setw(width) << std::left << "Repair operator " + std::to_string(operator_id) + ": "
+                << repair_operators_number_of_uses[operator_id] << std::endl
+                ;
+        }
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfIterations", number_of_iterations},
+                {"DestroyOperatorsNumberOfUses", destroy_operators_number_of_uses},
+                {"RepairOperatorsNumberOfUses", repair_operators_number_of_uses}});
+        return json;
+    }
+};
+
+/**
+ * Large neighborhood search.
+ *
+ * At each iteration, a destroy operator unassigns some items of the current
+ * solution and a repair operator reassigns them. The new solution replaces
+ * the current one if it is not worse.
+ *
+ * Destroy operators:
+ * - agent subset: items of randomly selected agents
+ * - related items: items which can be exchanged at a small cost
+ * - random items
+ *
+ * Repair operators:
+ * - greedy-regret with the 'cij' desirability
+ * - MILP restricted to the unassigned items (see 'milp_repair')
+ *
+ * Operators are selected by roulette wheel, with weights adapted from the
+ * results of the iterations of the previous segments. Threads run
+ * independent searches and share the best solution found, from which they
+ * restart when they stagnate.
+ */
+const LargeNeighborhoodSearchOutput large_neighborhood_search(
+        const Instance& instance,
+        const LargeNeighborhoodSearchParameters& parameters = {});
+
+}
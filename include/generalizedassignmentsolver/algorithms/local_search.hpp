@@ -7,25 +7,58 @@ namespace generalizedassignmentsolver
 
 struct LocalSearchParameters: Parameters
 {
-    /** Number of threads. */
+    /**
+     * Number of threads.
+     *
+     * Each thread runs its own best first local search with its own random
+     * stream.
+     */
     Counter number_of_threads = 1;
 
-    /** Maximum number of nodes. */
+    /**
+     * Number of nodes of a thread between two imports of elite solutions
+     * from the other threads.
+     *
+     * Only used if 'number_of_threads > 1'.
+     */
+    Counter elite_import_interval = 10;
+
+    /** Maximum number of nodes, summed over all threads. */
     Counter maximum_number_of_nodes = -1;
 
     /** Initial solution. */
     const Solution* initial_solution = nullptr;
 
+    /**
+     * Use adaptive penalties for capacity violations.
+     *
+     * If 'false', solutions are compared lexicographically on their
+     * overweight and their cost.
+     */
+    bool adaptive_penalty = false;
+
+    /**
+     * Maximum number of moves of the variable-depth search chains run on the
+     * local optima.
+     *
+     * Set to '0' to disable the variable-depth search.
+     */
+    ItemIdx variable_depth_search_maximum_depth = 0;
+
 
-    virtual int format_width() const override { return 26; }
+    virtual int format_width() const override { return 30; }
 
     virtual void format(std::ostream& os) const override
     {
         Parameters::format(os);
         int width = format_width();
         os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Elite import interval: " << elite_import_interval << std::endl
             << std::setw(width) << std::left << "Maximum number of nodes: " << maximum_number_of_nodes << std::endl
             << std::setw(width) << std::left << "Has initial solution: " << (initial_solution != nullptr) << std::endl
+            << std::setw(width) << std::left << "Adaptive penalty: " << adaptive_penalty << std::endl
+            << std::setw(width) << std::left << "Variable-depth search depth: " << variable_depth_search_maximum_depth << std::endl
             ;
     }
 
@@ -33,16 +66,577 @@ struct LocalSearchParameters: Parameters
     {
         nlohmann::json json = Parameters::to_json();
         json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                {"EliteImportInterval", elite_import_interval},
                 {"MaximumNumberOfNodes", maximum_number_of_nodes},
                 {"HasInitialSolution", (initial_solution != nullptr)},
+                {"AdaptivePenalty", adaptive_penalty},
+                {"VariableDepthSearchMaximumDepth", variable_depth_search_maximum_depth},
                 });
         return json;
     }
 };
 
-const Output local_search(
+struct LocalSearchOutput: Output
+{
+    LocalSearchOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /**
+     * Number of buffer allocations of the local search workspaces.
+     *
+     * It counts the creations of the workspaces and the growths of their
+     * buffers; it stops increasing once each thread has a workspace of its
+     * final size.
+     *
+     * It doesn't count all the allocations: the local search still
+     * allocates memory at each node in the steady state. The solutions are
+     * copied by the local search framework, and the perturbations, their
+     * lists of moves and the sampled items are returned by value; none of
+     * them are taken from the workspaces.
+     */
+    Counter number_of_workspace_buffer_allocations = 0;
+
+    /**
+     * Number of duplicate perturbations avoided.
+     *
+     * It counts the perturbations drawn twice for the same solution, which
+     * are drawn again. The duplicates discarded by the search frontier are
+     * not counted.
+     */
+    Counter number_of_duplicate_perturbations = 0;
+
+    /** Number of nodes, summed over all threads. */
+    Counter number_of_nodes = 0;
+
+    /** Number of elite solutions imported from another thread. */
+    Counter number_of_elite_imports = 0;
+
+    /** Number of variable-depth search chains. */
+    Counter number_of_variable_depth_search_chains = 0;
+
+    /** Number of variable-depth search chains which improved a solution. */
+    Counter number_of_improving_variable_depth_search_chains = 0;
+
+
+    virtual int format_width() const override { return 44; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of workspace buffer allocations: " << number_of_workspace_buffer_allocations << std::endl
+            << std::setw(width) << std::left << "Number of duplicate perturbations: " << number_of_duplicate_perturbations << std::endl
+            << std::setw(width) << std::left << "Number of nodes: " << number_of_nodes << std::endl
+            << std::setw(width) << std::left << "Number of elite imports: " << number_of_elite_imports << std::endl
+            << std::setw(width) << std::left << "Number of variable-depth chains: " << number_of_variable_depth_search_chains << std::endl
+            << std::setw(width) << std::left << "Number of improving variable-depth chains: " << number_of_improving_variable_depth_search_chains << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfWorkspaceBufferAllocations", number_of_workspace_buffer_allocations},
+                {"NumberOfDuplicatePerturbations", number_of_duplicate_perturbations},
+                {"NumberOfNodes", number_of_nodes},
+                {"NumberOfEliteImports", number_of_elite_imports},
+                {"NumberOfVariableDepthSearchChains", number_of_variable_depth_search_chains},
+                {"NumberOfImprovingVariableDepthSearchChains", number_of_improving_variable_depth_search_chains}});
+        return json;
+    }
+};
+
+const LocalSearchOutput local_search(
         const Instance& instance,
         std::mt19937_64& generator,
         const LocalSearchParameters& parameters = {});
 
+struct VariableDepthSearchParameters: Parameters
+{
+    /** Maximum number of moves of a chain. */
+    ItemIdx maximum_depth = 20;
+
+    /** Number of alternative moves tried at each of the first two levels. */
+    Counter breadth = 3;
+
+    /**
+     * Initial solution.
+     *
+     * If there is none, the search starts from a random solution drawn from
+     * the generator.
+     */
+    const Solution* initial_solution = nullptr;
+
+
+    virtual int format_width() const override { return 22; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Maximum depth: " << maximum_depth << std::endl
+            << std::setw(width) << std::left << "Breadth: " << breadth << std::endl
+            << std::setw(width) << std::left << "Has initial solution: " << (initial_solution != nullptr) << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"MaximumDepth", maximum_depth},
+                {"Breadth", breadth},
+                {"HasInitialSolution", (initial_solution != nullptr)},
+                });
+        return json;
+    }
+};
+
+struct VariableDepthSearchOutput: Output
+{
+    VariableDepthSearchOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /** Number of chains. */
+    Counter number_of_chains = 0;
+
+    /** Number of chains which improved the solution. */
+    Counter number_of_improving_chains = 0;
+
+
+    virtual int format_width() const override { return 31; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of chains: " << number_of_chains << std::endl
+            << std::setw(width) << std::left << "Number of improving chains: " << number_of_improving_chains << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfChains", number_of_chains},
+                {"NumberOfImprovingChains", number_of_improving_chains}});
+        return json;
+    }
+};
+
+/**
+ * Variable-depth search, in the spirit of the Lin-Kernighan heuristic.
+ *
+ * Chains of shift moves are built from the current solution, tentatively
+ * accepting worsening moves as long as the cost remains smaller than the
+ * cost of the current solution; only the first two levels of a chain are
+ * backtracked. The best prefix of an improving chain is applied, followed by
+ * a descent, until no chain improves the solution.
+ *
+ * Apart from the initial solution, the search is deterministic.
+ */
+const VariableDepthSearchOutput variable_depth_search(
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const VariableDepthSearchParameters& parameters = {});
+
+struct TabuSearchParameters: Parameters
+{
+    /** Number of threads. */
+    Counter number_of_threads = 1;
+
+    /** Maximum number of iterations, summed over all threads. */
+    Counter maximum_number_of_iterations = -1;
+
+    /**
+     * Maximum number of iterations without improvement before a thread
+     * restarts from the best solution found so far.
+     *
+     * '-1': '10 * number_of_items'.
+     */
+    Counter maximum_number_of_iterations_without_improvement = -1;
+
+    /**
+     * Tabu tenure.
+     *
+     * After moving an item out of an agent, moving it back is tabu for a
+     * number of iterations drawn uniformly in
+     * '[tabu_tenure, 2 * tabu_tenure]'.
+     */
+    Counter tabu_tenure = 10;
+
+    /**
+     * Weight of the long-term frequency memory.
+     *
+     * Non-improving moves are penalized proportionally to the number of
+     * times the item has already been moved to the agent.
+     */
+    double diversification_factor = 0.5;
+
+    /** Seed; thread 'i' uses 'seed + i'. */
+    Seed seed = 0;
+
+    /** Initial solution. */
+    const Solution* initial_solution = nullptr;
+
+
+    virtual int format_width() const override { return 41; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Maximum number of iterations: " << maximum_number_of_iterations << std::endl
+            << std::setw(width) << std::left << "Max. nb. of it. without improvement: " << maximum_number_of_iterations_without_improvement << std::endl
+            << std::setw(width) << std::left << "Tabu tenure: " << tabu_tenure << std::endl
+            << std::setw(width) << std::left << "Diversification factor: " << diversification_factor << std::endl
+            << std::setw(width) << std::left << "Seed: " << seed << std::endl
+            << std::setw(width) << std::left << "Has initial solution: " << (initial_solution != nullptr) << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                {"MaximumNumberOfIterations", maximum_number_of_iterations},
+                {"MaximumNumberOfIterationsWithoutImprovement", maximum_number_of_iterations_without_improvement},
+                {"TabuTenure", tabu_tenure},
+                {"DiversificationFactor", diversification_factor},
+                {"Seed", seed},
+                {"HasInitialSolution", (initial_solution != nullptr)},
+                });
+        return json;
+    }
+};
+
+struct TabuSearchOutput: Output
+{
+    TabuSearchOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /** Number of iterations. */
+    Counter number_of_iterations = 0;
+
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of iterations: " << number_of_iterations << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfIterations", number_of_iterations}});
+        return json;
+    }
+};
+
+/**
+ * Tabu search.
+ *
+ * At each iteration, the best non-tabu shift or swap move is applied, even
+ * if it is not improving. Swap moves are restricted to the candidate agents
+ * of the first item. Threads run independent searches and share the best
+ * solution found, from which they restart when they stagnate.
+ */
+const TabuSearchOutput tabu_search(
+        const Instance& instance,
+        const TabuSearchParameters& parameters = {});
+
+struct PathRelinkingParameters: Parameters
+{
+    /** Number of threads. */
+    Counter number_of_threads = 1;
+
+    /** Maximum number of paths, summed over all threads. */
+    Counter maximum_number_of_paths = -1;
+
+    /** Size of the pool of elite solutions. */
+    Counter elite_pool_size = 10;
+
+    /**
+     * Number of intermediate solutions of each path from which a local
+     * search is run.
+     */
+    Counter number_of_local_searches_per_path = 3;
+
+    /** Seed; thread 'i' uses 'seed + i'. */
+    Seed seed = 0;
+
+    /** Initial solution. */
+    const Solution* initial_solution = nullptr;
+
+
+    virtual int format_width() const override { return 41; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Maximum number of paths: " << maximum_number_of_paths << std::endl
+            << std::setw(width) << std::left << "Elite pool size: " << elite_pool_size << std::endl
+            << std::setw(width) << std::left << "Number of local searches per path: " << number_of_local_searches_per_path << std::endl
+            << std::setw(width) << std::left << "Seed: " << seed << std::endl
+            << std::setw(width) << std::left << "Has initial solution: " << (initial_solution != nullptr) << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                {"MaximumNumberOfPaths", maximum_number_of_paths},
+                {"ElitePoolSize", elite_pool_size},
+                {"NumberOfLocalSearchesPerPath", number_of_local_searches_per_path},
+                {"Seed", seed},
+                {"HasInitialSolution", (initial_solution != nullptr)},
+                });
+        return json;
+    }
+};
+
+struct PathRelinkingOutput: Output
+{
+    PathRelinkingOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /** Number of paths. */
+    Counter number_of_paths = 0;
+
+    /** Number of solutions inserted in the elite pool. */
+    Counter number_of_pool_updates = 0;
+
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of paths: " << number_of_paths << std::endl
+            << std::setw(width) << std::left << "Number of pool updates: " << number_of_pool_updates << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfPaths", number_of_paths},
+                {"NumberOfPoolUpdates", number_of_pool_updates}});
+        return json;
+    }
+};
+
+/**
+ * Path relinking.
+ *
+ * A pool of elite solutions is built by running the local search from
+ * random solutions. Then, each thread repeatedly picks two elite solutions
+ * and walks from the first one toward the second one, reassigning at each
+ * step the differing item whose reassignment leads to the best solution.
+ * The local search is run from some intermediate solutions of the path and
+ * the solutions obtained are inserted back into the pool.
+ */
+const PathRelinkingOutput path_relinking(
+        const Instance& instance,
+        const PathRelinkingParameters& parameters = {});
+
+struct SimulatedAnnealingParameters: Parameters
+{
+    /**
+     * Number of threads.
+     *
+     * Without parallel tempering, each thread runs an independent annealing.
+     * With parallel tempering, each thread runs a replica.
+     */
+    Counter number_of_threads = 1;
+
+    /** Maximum number of moves, summed over all threads. */
+    Counter maximum_number_of_moves = -1;
+
+    /**
+     * Initial temperature.
+     *
+     * '-1': average absolute cost difference of random shift moves.
+     */
+    double initial_temperature = -1;
+
+    /**
+     * Final temperature.
+     *
+     * '-1': 'initial_temperature / 1000'.
+     */
+    double final_temperature = -1;
+
+    /** Cooling schedule: "geometric" or "linear". */
+    std::string cooling_schedule = "geometric";
+
+    /**
+     * Cooling factor of the geometric cooling schedule.
+     *
+     * The linear cooling schedule uses the same number of temperature
+     * levels.
+     */
+    double cooling_factor = 0.95;
+
+    /**
+     * Number of moves at each temperature level.
+     *
+     * '-1': 'number_of_items * number_of_agents'.
+     */
+    Counter number_of_moves_per_temperature = -1;
+
+    /** Probability to draw a swap move instead of a shift move. */
+    double swap_probability = 0.5;
+
+    /**
+     * Penalty of a unit of overweight.
+     *
+     * '-1': 'maximum_cost + 1'.
+     */
+    double overweight_penalty = -1;
+
+    /**
+     * Use parallel tempering.
+     *
+     * The replicas run at fixed temperatures, geometrically spaced between
+     * the initial and the final temperatures, and exchange their
+     * temperatures every 'exchange_interval' moves.
+     */
+    bool parallel_tempering = false;
+
+    /** Number of moves of each replica between two exchanges. */
+    Counter exchange_interval = 10000;
+
+    /** Seed; thread 'i' uses 'seed + i'. */
+    Seed seed = 0;
+
+    /** Initial solution. */
+    const Solution* initial_solution = nullptr;
+
+
+    virtual int format_width() const override { return 34; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Maximum number of moves: " << maximum_number_of_moves << std::endl
+            << std::setw(width) << std::left << "Initial temperature: " << initial_temperature << std::endl
+            << std::setw(width) << std::left << "Final temperature: " << final_temperature << std::endl
+            << std::setw(width) << std::left << "Cooling schedule: " << cooling_schedule << std::endl
+            << std::setw(width) << std::left << "Cooling factor: " << cooling_factor << std::endl
+            << std::setw(width) << std::left << "Number of moves per temperature: " << number_of_moves_per_temperature << std::endl
+            << std::setw(width) << std::left << "Swap probability: " << swap_probability << std::endl
+            << std::setw(width) << std::left << "Overweight penalty: " << overweight_penalty << std::endl
+            << std::setw(width) << std::left << "Parallel tempering: " << parallel_tempering << std::endl
+            << std::setw(width) << std::left << "Exchange interval: " << exchange_interval << std::endl
+            << std::setw(width) << std::left << "Seed: " << seed << std::endl
+            << std::setw(width) << std::left << "Has initial solution: " << (initial_solution != nullptr) << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                {"MaximumNumberOfMoves", maximum_number_of_moves},
+                {"InitialTemperature", initial_temperature},
+                {"FinalTemperature", final_temperature},
+                {"CoolingSchedule", cooling_schedule},
+                {"CoolingFactor", cooling_factor},
+                {"NumberOfMovesPerTemperature", number_of_moves_per_temperature},
+                {"SwapProbability", swap_probability},
+                {"OverweightPenalty", overweight_penalty},
+                {"ParallelTempering", parallel_tempering},
+                {"ExchangeInterval", exchange_interval},
+                {"Seed", seed},
+                {"HasInitialSolution", (initial_solution != nullptr)},
+                });
+        return json;
+    }
+};
+
+struct SimulatedAnnealingOutput: Output
+{
+    SimulatedAnnealingOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /** Number of moves. */
+    Counter number_of_moves = 0;
+
+    /** Number of accepted moves. */
+    Counter number_of_accepted_moves = 0;
+
+    /** Number of exchanges between replicas. */
+    Counter number_of_exchanges = 0;
+
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of moves: " << number_of_moves << std::endl
+            << std::setw(width) << std::left << "Number of accepted moves: " << number_of_accepted_moves << std::endl
+            << std::setw(width) << std::left << "Number of exchanges: " << number_of_exchanges << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfMoves", number_of_moves},
+                {"NumberOfAcceptedMoves", number_of_accepted_moves},
+                {"NumberOfExchanges", number_of_exchanges}});
+        return json;
+    }
+};
+
+/**
+ * Simulated annealing.
+ *
+ * At each step, a random shift or swap move is drawn and evaluated in
+ * constant time from the weights of the agents. It is accepted with the
+ * Metropolis criterion on the cost penalized by the overweight. When the
+ * temperature reaches the final temperature, it is reset to the initial
+ * temperature and the annealing restarts from the best solution of the
+ * thread.
+ */
+const SimulatedAnnealingOutput simulated_annealing(
+        const Instance& instance,
+        const SimulatedAnnealingParameters& parameters = {});
+
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "generalizedassignmentsolver/solution.hpp"
+#include "generalizedassignmentsolver/algorithms/reduced_cost_fixing.hpp"
 
 #include "mathoptsolverscmake/mathopt.hpp"
 
@@ -18,6 +19,12 @@ struct MilpParameters: Parameters
     /** Initial solution. */
     const Solution* initial_solution = NULL;
 
+    /**
+     * Reduced cost fixing of the instance; if not 'nullptr', the MILP is
+     * solved on its restricted instance.
+     */
+    const ReducedCostFixingOutput* reduced_cost_fixing = nullptr;
+
 
     virtual int format_width() const override { return 28; }
 
@@ -28,7 +35,14 @@ struct MilpParameters: Parameters
         os
             << std::setw(width) << std::left << "Maximum number of nodes: " << maximum_number_of_nodes << std::endl
             << std::setw(width) << std::left << "Has initial solution: " << (initial_solution != nullptr) << std::endl
+            << std::setw(width) << std::left << "Reduced cost fixing: " << (reduced_cost_fixing != nullptr) << std::endl
             ;
+        if (reduced_cost_fixing != nullptr) {
+            os
+                << std::setw(width) << std::left << "Removed alternatives: " << reduced_cost_fixing->number_of_removed_alternatives << std::endl
+                << std::setw(width) << std::left << "Fixed items: " << reduced_cost_fixing->number_of_fixed_items << std::endl
+                ;
+        }
     }
 
     virtual nlohmann::json to_json() const override
@@ -37,6 +51,8 @@ struct MilpParameters: Parameters
         json.merge_patch({
                 {"MaximumNumberOfNodes", maximum_number_of_nodes},
                 {"HasInitialSolution", (initial_solution != nullptr)},
+                {"ReducedCostFixing", (reduced_cost_fixing != nullptr)?
+                    reduced_cost_fixing->to_json(): nlohmann::json(false)},
                 });
         return json;
     }
@@ -76,4 +92,17 @@ MilpOutput milp(
         const Solution* initial_solution = nullptr,
         const MilpParameters& parameters = {});
 
+/**
+ * Complete a partial solution by solving the MILP restricted to its
+ * unassigned items.
+ *
+ * The assignments of the partial solution are kept. The capacities of the
+ * agents are reduced by the weights of the items already assigned. The
+ * partial solution is returned unchanged if no solution is found within the
+ * time limit.
+ */
+Solution milp_repair(
+        const Solution& partial_solution,
+        const MilpParameters& parameters = {});
+
 }
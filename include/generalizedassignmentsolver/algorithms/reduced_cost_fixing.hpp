@@ -0,0 +1,113 @@
+#pragma once
+
+#include "generalizedassignmentsolver/solution.hpp"
+
+namespace generalizedassignmentsolver
+{
+
+/**
+ * Instance restricted by reduced cost fixing, with the mapping back to the
+ * original instance.
+ *
+ * The items with a single remaining alternative are fixed: they are removed
+ * from the restricted instance and the capacities of their agents are
+ * reduced accordingly. In the restricted instance, the removed alternatives
+ * of the other items have a weight greater than the capacity of their
+ * agent; the algorithms don't create variables for such alternatives.
+ */
+struct ReducedCostFixingOutput
+{
+    /** Constructor. */
+    ReducedCostFixingOutput(
+            const Instance& original_instance,
+            const Instance& instance):
+        original_instance(original_instance),
+        instance(instance) { }
+
+
+    /** Original instance. */
+    const Instance& original_instance;
+
+    /** Restricted instance. */
+    Instance instance;
+
+    /** Upper bound used to fix the variables. */
+    Cost upper_bound;
+
+    /** Value of the Lagrangian dual function at the multipliers. */
+    double lagrangian_bound = 0;
+
+    /**
+     * For each item of the restricted instance, id of the item in the
+     * original instance.
+     */
+    std::vector<ItemIdx> original_item_ids;
+
+    /**
+     * For each item of the original instance, agent to which it is fixed,
+     * '-1' if it is not fixed.
+     */
+    std::vector<AgentIdx> fixed_items_agents;
+
+    /** Total cost of the fixed items. */
+    Cost fixed_cost = 0;
+
+    /** Number of alternatives removed. */
+    Counter number_of_removed_alternatives = 0;
+
+    /** Number of items fixed. */
+    ItemIdx number_of_fixed_items = 0;
+
+    /**
+     * 'true' iff the reduced cost fixing proved that no solution is strictly
+     * better than the upper bound.
+     */
+    bool no_better_solution = false;
+
+
+    /** Convert a solution of the restricted instance into an original solution. */
+    Solution solution(const Solution& restricted_solution) const;
+
+    /** Convert a bound of the restricted instance into an original bound. */
+    Cost bound(Cost restricted_bound) const;
+
+    /**
+     * Convert a solution of the original instance into a solution of the
+     * restricted instance.
+     *
+     * The returned solution is empty if the solution doesn't assign the
+     * fixed items to their agents, and infeasible if it uses a removed
+     * alternative.
+     */
+    Solution restricted_solution(const Solution& solution) const;
+
+    /**
+     * Convert duals of the original instance, agent rows first, into duals
+     * of the restricted instance; the duals of the fixed items are dropped.
+     */
+    std::vector<double> restricted_duals(const std::vector<double>& duals) const;
+
+    /** Export to JSON. */
+    nlohmann::json to_json() const;
+};
+
+/**
+ * Reduced cost fixing from the multipliers of the Lagrangian relaxation of
+ * the knapsack constraints.
+ *
+ * The Lagrangian reduced cost of assigning item 'j' to agent 'i' is
+ * 'c(j, i) + multipliers[i] * w(j, i)'. Assigning item 'j' to agent 'i'
+ * increases the value of the Lagrangian dual function by the difference
+ * between this reduced cost and the minimum reduced cost of item 'j'. If
+ * the resulting bound shows that no solution with this assignment is
+ * strictly better than 'upper_bound', the alternative is removed.
+ *
+ * The restricted instance contains all the solutions of the original
+ * instance strictly better than 'upper_bound'.
+ */
+ReducedCostFixingOutput reduced_cost_fixing(
+        const Instance& instance,
+        const std::vector<double>& multipliers,
+        Cost upper_bound);
+
+}
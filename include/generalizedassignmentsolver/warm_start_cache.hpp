@@ -0,0 +1,105 @@
+#pragma once
+
+#include "generalizedassignmentsolver/solution.hpp"
+
+namespace generalizedassignmentsolver
+{
+
+/**
+ * Get a hash of the content of an instance: its dimensions, capacities,
+ * weights and costs.
+ */
+uint64_t content_hash(const Instance& instance);
+
+/**
+ * Data of a previous run used to warm-start the next runs.
+ *
+ * An empty vector means that the data is not available.
+ */
+struct WarmStart
+{
+    /** Multipliers of the Lagrangian relaxation of the knapsack constraints. */
+    std::vector<double> lagrangian_relaxation_knapsack_multipliers;
+
+    /** Multipliers of the Lagrangian relaxation of the assignment constraints. */
+    std::vector<double> lagrangian_relaxation_assignment_multipliers;
+
+    /** Duals of the column generation, agent rows first. */
+    std::vector<double> column_generation_duals;
+
+    /** Agent of each item in the best solution. */
+    std::vector<AgentIdx> items_agents;
+
+
+    /**
+     * Get the best solution in an instance.
+     *
+     * The solution is empty if it is not available for the dimensions of
+     * the instance; it might be infeasible if the instance has been
+     * perturbed.
+     */
+    Solution solution(const Instance& instance) const;
+
+    /**
+     * Set the best solution if it is feasible and better than the current
+     * one in the instance of the solution.
+     */
+    void update_solution(const Solution& solution);
+};
+
+/**
+ * On-disk cache of warm starts.
+ *
+ * The cache is a directory which must exist. The warm start of an instance
+ * is stored in the file named after the content hash of the instance. It is
+ * also stored as the latest warm start for the dimensions of the instance,
+ * which is used for an instance which is not in the cache, typically a
+ * slightly perturbed version of a cached instance.
+ */
+class WarmStartCache
+{
+
+public:
+
+    /** Constructor. */
+    WarmStartCache(const std::string& directory_path):
+        directory_path_(directory_path) { }
+
+    /**
+     * Load the warm start of an instance.
+     *
+     * Return 'false' and leave 'warm_start' unchanged if the cache contains
+     * neither the instance nor an instance with the same dimensions, or if
+     * the cache file is invalid.
+     */
+    bool load(
+            const Instance& instance,
+            WarmStart& warm_start) const;
+
+    /** Save the warm start of an instance. */
+    void save(
+            const Instance& instance,
+            const WarmStart& warm_start) const;
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /** Get the path of the file of a content hash. */
+    std::string hash_path(const Instance& instance) const;
+
+    /** Get the path of the file of the dimensions of an instance. */
+    std::string dimensions_path(const Instance& instance) const;
+
+    /*
+     * Private attributes
+     */
+
+    /** Path of the directory of the cache. */
+    std::string directory_path_;
+
+};
+
+}
@@ -108,3 +108,957 @@ if args.tests is None or "greedy" in args.tests:
         print()
     print()
     print()
+
+
+greedy_portfolio_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "greedy-portfolio" in args.tests:
+    print("Greedy portfolio")
+    print("----------------")
+    print()
+
+    for instance, instance_format in greedy_portfolio_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "greedy_portfolio",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"greedy-portfolio\""
+                + "  --threads 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+grasp_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "grasp" in args.tests:
+    print("GRASP")
+    print("-----")
+    print()
+
+    for instance, instance_format in grasp_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+
+        for construction in ["greedy", "greedy-regret"]:
+
+            json_output_path = os.path.join(
+                    args.directory,
+                    "grasp",
+                    construction.replace("-", "_"),
+                    instance + ".json")
+            if not os.path.exists(os.path.dirname(json_output_path)):
+                os.makedirs(os.path.dirname(json_output_path))
+            command = (
+                    generalizedassignmentsolver_main
+                    + "  --verbosity-level 1"
+                    + "  --input \"" + instance_path + "\""
+                    + "  --format \"" + instance_format + "\""
+                    + "  --algorithm \"grasp\""
+                    + "  --desirability \"-pij/wij\""
+                    + "  --construction \"" + construction + "\""
+                    + "  --maximum-number-of-iterations 20"
+                    + "  --threads 2"
+                    + "  --output \"" + json_output_path + "\"")
+            print(command)
+            status = os.system(command)
+            if status != 0:
+                sys.exit(1)
+            print()
+        print()
+        print()
+
+
+greedy_repair_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+
+def write_perturbed_orlibrary_instance(
+        instance_path,
+        perturbed_instance_path):
+    """Write an instance without its last 5 items, with a larger capacity
+    for the first agent, and with the weights of the first item and the
+    costs of the second item increased."""
+    with open(instance_path) as f:
+        values = [int(value) for value in f.read().split()]
+    number_of_agents, number_of_items = values[0], values[1]
+    costs = [values[2 + agent_id * number_of_items:
+                    2 + (agent_id + 1) * number_of_items]
+             for agent_id in range(number_of_agents)]
+    offset = 2 + number_of_agents * number_of_items
+    weights = [values[offset + agent_id * number_of_items:
+                      offset + (agent_id + 1) * number_of_items]
+               for agent_id in range(number_of_agents)]
+    offset = 2 + 2 * number_of_agents * number_of_items
+    capacities = values[offset:offset + number_of_agents]
+
+    number_of_items -= 5
+    capacities[0] = capacities[0] * 11 // 10
+    for agent_id in range(number_of_agents):
+        weights[agent_id][0] += 1
+        costs[agent_id][1] += 3
+    with open(perturbed_instance_path, "w") as f:
+        f.write(str(number_of_agents) + " " + str(number_of_items) + "\n")
+        for rows in [costs, weights]:
+            for row in rows:
+                f.write(" ".join(str(value) for value in row[:number_of_items]) + "\n")
+        f.write(" ".join(str(value) for value in capacities) + "\n")
+
+
+if args.tests is None or "greedy-repair" in args.tests:
+    print("Greedy repair")
+    print("-------------")
+    print()
+
+    # The perturbed instances are kept out of the results directory since
+    # they are not test outputs.
+    perturbed_instances_directory = args.directory + "_greedy_repair"
+
+    for instance, instance_format in greedy_repair_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        perturbed_instance_path = os.path.join(
+                perturbed_instances_directory,
+                instance)
+        if not os.path.exists(os.path.dirname(perturbed_instance_path)):
+            os.makedirs(os.path.dirname(perturbed_instance_path))
+        write_perturbed_orlibrary_instance(
+                instance_path,
+                perturbed_instance_path)
+
+        # Without previous solution, the repair is a greedy-regret.
+        json_output_path = os.path.join(
+                args.directory,
+                "greedy_repair",
+                "empty",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"greedy-repair\""
+                + "  --desirability \"wij\""
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+
+        # Repair the greedy-regret solution of the perturbed instance into
+        # a solution of the instance, and conversely. The first direction
+        # adds items, the second one removes items.
+        for run, previous_instance_path, new_instance_path in [
+                ("added_items", perturbed_instance_path, instance_path),
+                ("removed_items", instance_path, perturbed_instance_path)]:
+
+            previous_certificate_path = os.path.join(
+                    perturbed_instances_directory,
+                    run,
+                    instance + "_solution.txt")
+            if not os.path.exists(os.path.dirname(previous_certificate_path)):
+                os.makedirs(os.path.dirname(previous_certificate_path))
+            command = (
+                    generalizedassignmentsolver_main
+                    + "  --verbosity-level 1"
+                    + "  --input \"" + previous_instance_path + "\""
+                    + "  --format \"" + instance_format + "\""
+                    + "  --algorithm \"greedy-regret\""
+                    + "  --desirability \"wij\""
+                    + "  --certificate \"" + previous_certificate_path + "\"")
+            print(command)
+            status = os.system(command)
+            if status != 0:
+                sys.exit(1)
+            print()
+
+            json_output_path = os.path.join(
+                    args.directory,
+                    "greedy_repair",
+                    run,
+                    instance + ".json")
+            if not os.path.exists(os.path.dirname(json_output_path)):
+                os.makedirs(os.path.dirname(json_output_path))
+            command = (
+                    generalizedassignmentsolver_main
+                    + "  --verbosity-level 1"
+                    + "  --input \"" + new_instance_path + "\""
+                    + "  --format \"" + instance_format + "\""
+                    + "  --algorithm \"greedy-repair\""
+                    + "  --desirability \"wij\""
+                    + "  --previous-instance \"" + previous_instance_path + "\""
+                    + "  --initial-solution \"" + previous_certificate_path + "\""
+                    + "  --output \"" + json_output_path + "\"")
+            print(command)
+            status = os.system(command)
+            if status != 0:
+                sys.exit(1)
+            print()
+    print()
+    print()
+
+
+tabu_search_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "tabu-search" in args.tests:
+    print("Tabu search")
+    print("-----------")
+    print()
+
+    for instance, instance_format in tabu_search_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "tabu_search",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"tabu-search\""
+                + "  --maximum-number-of-iterations 1000"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+path_relinking_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "path-relinking" in args.tests:
+    print("Path relinking")
+    print("--------------")
+    print()
+
+    for instance, instance_format in path_relinking_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "path_relinking",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"path-relinking\""
+                + "  --maximum-number-of-paths 20"
+                + "  --threads 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+large_neighborhood_search_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "large-neighborhood-search" in args.tests:
+    print("Large neighborhood search")
+    print("-------------------------")
+    print()
+
+    for instance, instance_format in large_neighborhood_search_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "large_neighborhood_search",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"large-neighborhood-search\""
+                + "  --maximum-number-of-iterations 200"
+                + "  --threads 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+simulated_annealing_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "simulated-annealing" in args.tests:
+    print("Simulated annealing")
+    print("-------------------")
+    print()
+
+    for instance, instance_format in simulated_annealing_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "simulated_annealing",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"simulated-annealing\""
+                + "  --maximum-number-of-moves 100000"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+simulated_annealing_parallel_tempering_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "simulated-annealing" in args.tests:
+    print("Simulated annealing, parallel tempering")
+    print("---------------------------------------")
+    print()
+
+    for instance, instance_format in simulated_annealing_parallel_tempering_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "simulated_annealing_parallel_tempering",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"simulated-annealing\""
+                + "  --maximum-number-of-moves 100000"
+                + "  --parallel-tempering"
+                + "  --threads 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+local_search_threads_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "local-search" in args.tests:
+    print("Local search, two threads")
+    print("-------------------------")
+    print()
+
+    for instance, instance_format in local_search_threads_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "local_search_threads",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"local-search\""
+                + "  --maximum-number-of-nodes 100"
+                + "  --threads 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+variable_depth_search_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "variable-depth-search" in args.tests:
+    print("Variable-depth search")
+    print("---------------------")
+    print()
+
+    for instance, instance_format in variable_depth_search_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "variable_depth_search",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"variable-depth-search\""
+                + "  --variable-depth-search-maximum-depth 8"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+lagrangian_relaxation_assignment_subgradient_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "lagrangian-relaxation" in args.tests:
+    print("Lagrangian relaxation of the assignment constraints, subgradient")
+    print("----------------------------------------------------------------")
+    print()
+
+    for instance, instance_format in lagrangian_relaxation_assignment_subgradient_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "lagrangian_relaxation_assignment_subgradient",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"lagrangian-relaxation-assignment\""
+                + "  --dual-optimizer subgradient"
+                + "  --maximum-number-of-iterations 100"
+                + "  --threads 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+lagrangian_relaxation_assignment_bundle_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "lagrangian-relaxation" in args.tests:
+    print("Lagrangian relaxation of the assignment constraints, bundle")
+    print("-----------------------------------------------------------")
+    print()
+
+    for instance, instance_format in lagrangian_relaxation_assignment_bundle_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "lagrangian_relaxation_assignment_bundle",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"lagrangian-relaxation-assignment\""
+                + "  --dual-optimizer bundle"
+                + "  --maximum-number-of-iterations 100"
+                + "  --threads 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+lagrangian_relaxation_knapsack_subgradient_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "lagrangian-relaxation" in args.tests:
+    print("Lagrangian relaxation of the knapsack constraints, subgradient")
+    print("--------------------------------------------------------------")
+    print()
+
+    for instance, instance_format in lagrangian_relaxation_knapsack_subgradient_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "lagrangian_relaxation_knapsack_subgradient",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"lagrangian-relaxation-knapsack\""
+                + "  --dual-optimizer subgradient"
+                + "  --maximum-number-of-iterations 100"
+                + "  --threads 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+lagrangian_relaxation_knapsack_bundle_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "lagrangian-relaxation" in args.tests:
+    print("Lagrangian relaxation of the knapsack constraints, bundle")
+    print("---------------------------------------------------------")
+    print()
+
+    for instance, instance_format in lagrangian_relaxation_knapsack_bundle_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "lagrangian_relaxation_knapsack_bundle",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"lagrangian-relaxation-knapsack\""
+                + "  --dual-optimizer bundle"
+                + "  --maximum-number-of-iterations 100"
+                + "  --threads 2"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+lagrangian_relaxation_assignment_heuristic_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "lagrangian-heuristic" in args.tests:
+    print("Lagrangian relaxation of the assignment constraints, Lagrangian heuristic")
+    print("-------------------------------------------------------------------------")
+    print()
+
+    for instance, instance_format in lagrangian_relaxation_assignment_heuristic_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "lagrangian_relaxation_assignment_heuristic",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"lagrangian-relaxation-assignment\""
+                + "  --lagrangian-heuristic"
+                + "  --maximum-number-of-iterations 100"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+lagrangian_relaxation_knapsack_heuristic_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "lagrangian-heuristic" in args.tests:
+    print("Lagrangian relaxation of the knapsack constraints, Lagrangian heuristic")
+    print("-----------------------------------------------------------------------")
+    print()
+
+    for instance, instance_format in lagrangian_relaxation_knapsack_heuristic_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "lagrangian_relaxation_knapsack_heuristic",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"lagrangian-relaxation-knapsack\""
+                + "  --lagrangian-heuristic"
+                + "  --maximum-number-of-iterations 100"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+milp_reduced_cost_fixing_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "reduced-cost-fixing" in args.tests:
+    print("MILP, reduced cost fixing")
+    print("-------------------------")
+    print()
+
+    for instance, instance_format in milp_reduced_cost_fixing_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "milp_reduced_cost_fixing",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"milp\""
+                + "  --solver highs"
+                + "  --reduced-cost-fixing"
+                + "  --time-limit 10"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+column_generation_reduced_cost_fixing_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "reduced-cost-fixing" in args.tests:
+    print("Column generation, reduced cost fixing")
+    print("--------------------------------------")
+    print()
+
+    for instance, instance_format in column_generation_reduced_cost_fixing_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+        json_output_path = os.path.join(
+                args.directory,
+                "column_generation_reduced_cost_fixing",
+                instance + ".json")
+        if not os.path.exists(os.path.dirname(json_output_path)):
+            os.makedirs(os.path.dirname(json_output_path))
+        command = (
+                generalizedassignmentsolver_main
+                + "  --verbosity-level 1"
+                + "  --input \"" + instance_path + "\""
+                + "  --format \"" + instance_format + "\""
+                + "  --algorithm \"column-generation\""
+                + "  --reduced-cost-fixing"
+                + "  --time-limit 10"
+                + "  --output \"" + json_output_path + "\"")
+        print(command)
+        status = os.system(command)
+        if status != 0:
+            sys.exit(1)
+        print()
+    print()
+    print()
+
+
+warm_start_cache_data = [
+        (os.path.join("chu1997", "a05100"), "orlibrary"),
+        (os.path.join("chu1997", "a10100"), "orlibrary"),
+        (os.path.join("chu1997", "b05100"), "orlibrary"),
+        (os.path.join("chu1997", "b10100"), "orlibrary"),
+        (os.path.join("chu1997", "c05100"), "orlibrary"),
+        (os.path.join("chu1997", "c10100"), "orlibrary"),
+        (os.path.join("chu1997", "d05100"), "orlibrary"),
+        (os.path.join("chu1997", "d10100"), "orlibrary"),
+        ]
+
+if args.tests is None or "warm-start-cache" in args.tests:
+    print("Warm start cache")
+    print("----------------")
+    print()
+
+    # The cache is kept out of the results directory since its files are
+    # not test outputs.
+    warm_start_cache_path = args.directory + "_warm_start_cache"
+    if not os.path.exists(warm_start_cache_path):
+        os.makedirs(warm_start_cache_path)
+
+    for instance, instance_format in warm_start_cache_data:
+        instance_path = os.path.join(
+                data_dir,
+                instance)
+
+        # The first run starts from the entry of the previous instance with
+        # the same dimensions, if any, and stores the entry of the instance.
+        # The second run starts from this entry.
+        for run in ["first", "second"]:
+
+            json_output_path = os.path.join(
+                    args.directory,
+                    "warm_start_cache",
+                    run,
+                    instance + ".json")
+            if not os.path.exists(os.path.dirname(json_output_path)):
+                os.makedirs(os.path.dirname(json_output_path))
+            command = (
+                    generalizedassignmentsolver_main
+                    + "  --verbosity-level 1"
+                    + "  --input \"" + instance_path + "\""
+                    + "  --format \"" + instance_format + "\""
+                    + "  --algorithm \"lagrangian-relaxation-knapsack\""
+                    + "  --maximum-number-of-iterations 20"
+                    + "  --warm-start-cache \"" + warm_start_cache_path + "\""
+                    + "  --output \"" + json_output_path + "\"")
+            print(command)
+            status = os.system(command)
+            if status != 0:
+                sys.exit(1)
+            print()
+        print()
+        print()
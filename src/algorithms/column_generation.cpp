@@ -30,15 +30,12 @@
  */
 
 #include "generalizedassignmentsolver/algorithms/column_generation.hpp"
+#include "generalizedassignmentsolver/algorithms/knapsack_subproblems.hpp"
 #include "generalizedassignmentsolver/algorithm_formatter.hpp"
 
 #include "columngenerationsolver/algorithms/greedy.hpp"
 #include "columngenerationsolver/algorithms/limited_discrepancy_search.hpp"
 
-#include "knapsacksolver/instance_builder.hpp"
-#include "knapsacksolver/algorithms/dynamic_programming_primal_dual.hpp"
-//#include "knapsacksolver/algorithms/dynamic_programming_bellman.hpp"
-
 #include <iostream>
 
 using namespace generalizedassignmentsolver;
@@ -52,11 +49,37 @@ class PricingSolver: public columngenerationsolver::PricingSolver
 
 public:
 
-    PricingSolver(const Instance& instance):
+    PricingSolver(
+            const Instance& instance,
+            KnapsackSubproblems& knapsack_subproblems,
+            const ColumnGenerationParameters& parameters):
         instance_(instance),
+        knapsack_subproblems_(knapsack_subproblems),
+        parameters_(parameters),
         fixed_items_(instance.number_of_items()),
-        fixed_agents_(instance.number_of_agents())
-    {  }
+        fixed_agents_(instance.number_of_agents()),
+        initial_solution_(instance)
+    {
+        // With reduced cost fixing, the initial solution and the initial
+        // duals are given for the original instance; convert them to the
+        // restricted instance.
+        const ReducedCostFixingOutput* reduced_cost_fixing = parameters.reduced_cost_fixing;
+        const Instance& original_instance = (reduced_cost_fixing != nullptr)?
+            reduced_cost_fixing->original_instance: instance;
+        if (parameters.initial_solution != nullptr
+                && &parameters.initial_solution->instance() == &original_instance) {
+            initial_solution_ = (reduced_cost_fixing != nullptr)?
+                reduced_cost_fixing->restricted_solution(*parameters.initial_solution):
+                *parameters.initial_solution;
+        }
+        if (parameters.initial_duals != nullptr
+                && (ItemIdx)parameters.initial_duals->size()
+                == original_instance.number_of_agents() + original_instance.number_of_items()) {
+            initial_duals_ = (reduced_cost_fixing != nullptr)?
+                reduced_cost_fixing->restricted_duals(*parameters.initial_duals):
+                *parameters.initial_duals;
+        }
+    }
 
     virtual std::vector<std::shared_ptr<const Column>> initialize_pricing(
             const std::vector<std::pair<std::shared_ptr<const Column>, Value>>& fixed_columns);
@@ -64,19 +87,40 @@ public:
     virtual PricingOutput solve_pricing(
             const std::vector<Value>& duals);
 
+    /** Get the duals of the last call to 'solve_pricing'. */
+    const std::vector<Value>& duals() const { return duals_; }
+
 private:
 
+    /** Solve the subproblem of an agent and build the corresponding column. */
+    std::shared_ptr<const Column> solve_subproblem(
+            AgentIdx agent_id,
+            const std::vector<Value>& duals);
+
     const Instance& instance_;
 
+    KnapsackSubproblems& knapsack_subproblems_;
+
+    const ColumnGenerationParameters& parameters_;
+
+    std::vector<Value> duals_;
+
     std::vector<int8_t> fixed_items_;
 
     std::vector<int8_t> fixed_agents_;
 
-    std::vector<ItemIdx> kp2gap_;
+    /** Initial solution of the model instance. */
+    Solution initial_solution_;
+
+    /** Initial duals of the model instance; empty if none. */
+    std::vector<Value> initial_duals_;
 
 };
 
-columngenerationsolver::Model get_model(const Instance& instance)
+columngenerationsolver::Model get_model(
+        const Instance& instance,
+        KnapsackSubproblems& knapsack_subproblems,
+        const ColumnGenerationParameters& parameters)
 {
     columngenerationsolver::Model model;
 
@@ -108,7 +152,7 @@ columngenerationsolver::Model get_model(const Instance& instance)
 
     // Pricing solver.
     model.pricing_solver = std::unique_ptr<columngenerationsolver::PricingSolver>(
-            new PricingSolver(instance));
+            new PricingSolver(instance, knapsack_subproblems, parameters));
 
     return model;
 }
@@ -141,6 +185,62 @@ Solution columns2solution(
     return solution;
 }
 
+/**
+ * Get the instance on which the column generation is run: the restricted
+ * instance if reduced cost fixing is used, the instance itself otherwise.
+ */
+const Instance& get_model_instance(
+        const Instance& instance,
+        const ColumnGenerationParameters& parameters)
+{
+    if (parameters.reduced_cost_fixing == nullptr)
+        return instance;
+    if (&parameters.reduced_cost_fixing->original_instance != &instance) {
+        throw std::invalid_argument(
+                "generalizedassignmentsolver::column_generation: "
+                "reduced cost fixing of another instance.");
+    }
+    return parameters.reduced_cost_fixing->instance;
+}
+
+/** Retrieve a solution of the original instance. */
+Solution retrieve_solution(
+        const ColumnGenerationParameters& parameters,
+        const Solution& solution)
+{
+    if (parameters.reduced_cost_fixing == nullptr)
+        return solution;
+    return parameters.reduced_cost_fixing->solution(solution);
+}
+
+/** Retrieve a bound of the original instance. */
+Cost retrieve_bound(
+        const ColumnGenerationParameters& parameters,
+        Cost bound)
+{
+    if (parameters.reduced_cost_fixing == nullptr)
+        return bound;
+    return parameters.reduced_cost_fixing->bound(bound);
+}
+
+/**
+ * Return 'true' iff reduced cost fixing proved that the upper bound is
+ * optimal, in which case the bound is updated.
+ */
+bool no_better_solution(
+        const ColumnGenerationParameters& parameters,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    if (parameters.reduced_cost_fixing == nullptr
+            || !parameters.reduced_cost_fixing->no_better_solution) {
+        return false;
+    }
+    algorithm_formatter.update_bound(
+            parameters.reduced_cost_fixing->upper_bound,
+            "reduced cost fixing");
+    return true;
+}
+
 std::vector<std::shared_ptr<const Column>> PricingSolver::initialize_pricing(
             const std::vector<std::pair<std::shared_ptr<const Column>, Value>>& fixed_columns)
 {
@@ -161,73 +261,105 @@ std::vector<std::shared_ptr<const Column>> PricingSolver::initialize_pricing(
             }
         }
     }
-    return {};
-}
-
-PricingOutput PricingSolver::solve_pricing(
-            const std::vector<Value>& duals)
-{
-    PricingOutput output;
-    Value reduced_cost_bound = 0.0;
-
     for (AgentIdx agent_id = 0;
             agent_id < instance_.number_of_agents();
             ++agent_id) {
         if (fixed_agents_[agent_id] == 1)
             continue;
+        knapsack_subproblems_.set_subproblem(
+                agent_id,
+                instance_.capacity(agent_id),
+                [this](ItemIdx item_id) { return fixed_items_[item_id] == 1; });
+    }
 
-        // Build subproblem instance.
-        knapsacksolver::InstanceFromFloatProfitsBuilder kp_instance_builder;
-        kp_instance_builder.set_capacity(instance_.capacity(agent_id));
-        kp2gap_.clear();
+    // Warm start.
+    std::vector<std::shared_ptr<const Column>> columns;
+    if (initial_solution_.feasible()) {
+        std::vector<Column> agents_columns(instance_.number_of_agents());
+        std::vector<int8_t> agents_compatible(instance_.number_of_agents(), 1);
+        for (AgentIdx agent_id = 0;
+                agent_id < instance_.number_of_agents();
+                ++agent_id) {
+            columngenerationsolver::LinearTerm element;
+            element.row = agent_id;
+            element.coefficient = 1;
+            agents_columns[agent_id].elements.push_back(element);
+            if (fixed_agents_[agent_id] == 1)
+                agents_compatible[agent_id] = 0;
+        }
         for (ItemIdx item_id = 0;
                 item_id < instance_.number_of_items();
                 ++item_id) {
+            AgentIdx agent_id = initial_solution_.agent(item_id);
             if (fixed_items_[item_id] == 1)
+                agents_compatible[agent_id] = 0;
+            columngenerationsolver::LinearTerm element;
+            element.row = instance_.number_of_agents() + item_id;
+            element.coefficient = 1;
+            agents_columns[agent_id].elements.push_back(element);
+            agents_columns[agent_id].objective_coefficient += instance_.cost(item_id, agent_id);
+        }
+        for (AgentIdx agent_id = 0;
+                agent_id < instance_.number_of_agents();
+                ++agent_id) {
+            if (agents_compatible[agent_id] == 1)
+                columns.push_back(std::shared_ptr<const Column>(new Column(agents_columns[agent_id])));
+        }
+    }
+    if (!initial_duals_.empty()) {
+        for (AgentIdx agent_id = 0;
+                agent_id < instance_.number_of_agents();
+                ++agent_id) {
+            if (fixed_agents_[agent_id] == 1)
                 continue;
-            double profit
-                = duals[instance_.number_of_agents() + item_id]
-                - instance_.cost(item_id, agent_id);
-            if (profit <= 0
-                    || instance_.weight(item_id, agent_id)
-                    > instance_.capacity(agent_id))
-                continue;
-            kp_instance_builder.add_item(
-                    profit,
-                    instance_.weight(item_id, agent_id));
-            kp2gap_.push_back(item_id);
+            columns.push_back(solve_subproblem(agent_id, initial_duals_));
         }
-        const knapsacksolver::Instance kp_instance = kp_instance_builder.build();
-
-        // Solve subproblem instance.
-        knapsacksolver::DynamicProgrammingPrimalDualParameters kp_parameters;
-        kp_parameters.verbosity_level = 0;
-        auto kp_output = knapsacksolver::dynamic_programming_primal_dual(
-                kp_instance,
-                kp_parameters);
+    }
+    return columns;
+}
 
-        // Retrieve column.
-        Column column;
+std::shared_ptr<const Column> PricingSolver::solve_subproblem(
+        AgentIdx agent_id,
+        const std::vector<Value>& duals)
+{
+    const std::vector<ItemIdx>& items = knapsack_subproblems_.solve(
+            agent_id,
+            duals,
+            instance_.number_of_agents());
+
+    Column column;
+    columngenerationsolver::LinearTerm element;
+    element.row = agent_id;
+    element.coefficient = 1;
+    column.elements.push_back(element);
+    for (ItemIdx item_id: items) {
         columngenerationsolver::LinearTerm element;
-        element.row = agent_id;
+        element.row = instance_.number_of_agents() + item_id;
         element.coefficient = 1;
         column.elements.push_back(element);
-        for (knapsacksolver::ItemId kp_item_id = 0;
-                kp_item_id < kp_instance.number_of_items();
-                ++kp_item_id) {
-            if (kp_output.solution.contains(kp_item_id)) {
-                ItemIdx item_id = kp2gap_[kp_item_id];
-                columngenerationsolver::LinearTerm element;
-                element.row = instance_.number_of_agents() + item_id;
-                element.coefficient = 1;
-                column.elements.push_back(element);
-                column.objective_coefficient += instance_.cost(item_id, agent_id);
-            }
-        }
-        output.columns.push_back(std::shared_ptr<const Column>(new Column(column)));
+        column.objective_coefficient += instance_.cost(item_id, agent_id);
+    }
+    return std::shared_ptr<const Column>(new Column(column));
+}
+
+PricingOutput PricingSolver::solve_pricing(
+            const std::vector<Value>& duals)
+{
+    PricingOutput output;
+    Value reduced_cost_bound = 0.0;
+    duals_ = duals;
+
+    for (AgentIdx agent_id = 0;
+            agent_id < instance_.number_of_agents();
+            ++agent_id) {
+        if (fixed_agents_[agent_id] == 1)
+            continue;
+
+        std::shared_ptr<const Column> column = solve_subproblem(agent_id, duals);
+        output.columns.push_back(column);
         reduced_cost_bound = (std::min)(
                 reduced_cost_bound,
-                columngenerationsolver::compute_reduced_cost(column, duals));
+                columngenerationsolver::compute_reduced_cost(*column, duals));
     }
 
     output.overcost = instance_.number_of_agents() * std::min(0.0, reduced_cost_bound);
@@ -247,7 +379,20 @@ const ColumnGenerationOutput generalizedassignmentsolver::column_generation(
     algorithm_formatter.start("Column generation");
     algorithm_formatter.print_header();
 
-    columngenerationsolver::Model model = get_model(instance);
+    const Instance& model_instance = get_model_instance(instance, parameters);
+    if (parameters.initial_solution != nullptr
+            && &parameters.initial_solution->instance() == &instance) {
+        algorithm_formatter.update_solution(
+                *parameters.initial_solution,
+                "initial solution");
+    }
+    if (no_better_solution(parameters, algorithm_formatter)) {
+        algorithm_formatter.end();
+        return output;
+    }
+
+    KnapsackSubproblems knapsack_subproblems(model_instance);
+    columngenerationsolver::Model model = get_model(model_instance, knapsack_subproblems, parameters);
     columngenerationsolver::ColumnGenerationParameters cgs_parameters;
     cgs_parameters.verbosity_level = 0;
     cgs_parameters.timer = parameters.timer;
@@ -259,9 +404,10 @@ const ColumnGenerationOutput generalizedassignmentsolver::column_generation(
     auto cgscg_output = columngenerationsolver::column_generation(model, cgs_parameters);
 
     Cost bound = std::ceil(cgscg_output.relaxation_solution.objective_value() - FFOT_TOL);
-    algorithm_formatter.update_bound(bound, "");
+    algorithm_formatter.update_bound(retrieve_bound(parameters, bound), "");
     output.number_of_added_columns = cgscg_output.columns.size();
     output.number_of_iterations = cgscg_output.number_of_column_generation_iterations;
+    output.dual_solution = static_cast<const PricingSolver&>(*model.pricing_solver).duals();
 
     algorithm_formatter.end();
     return output;
@@ -276,7 +422,14 @@ const ColumnGenerationHeuristicGreedyOutput generalizedassignmentsolver::column_
     algorithm_formatter.start("Column generation heuristic - greedy");
     algorithm_formatter.print_header();
 
-    columngenerationsolver::Model model = get_model(instance);
+    const Instance& model_instance = get_model_instance(instance, parameters);
+    if (no_better_solution(parameters, algorithm_formatter)) {
+        algorithm_formatter.end();
+        return output;
+    }
+
+    KnapsackSubproblems knapsack_subproblems(model_instance);
+    columngenerationsolver::Model model = get_model(model_instance, knapsack_subproblems, parameters);
     columngenerationsolver::GreedyParameters cgsg_parameters;
     cgsg_parameters.verbosity_level = 0;
     cgsg_parameters.timer = parameters.timer;
@@ -285,15 +438,15 @@ const ColumnGenerationHeuristicGreedyOutput generalizedassignmentsolver::column_
     cgsg_parameters.internal_diving = true;
     cgsg_parameters.column_generation_parameters.self_adjusting_wentges_smoothing = true;
     cgsg_parameters.column_generation_parameters.automatic_directional_smoothing = true;
-    cgsg_parameters.new_solution_callback = [&instance, &algorithm_formatter](
+    cgsg_parameters.new_solution_callback = [&model_instance, &parameters, &algorithm_formatter](
             const columngenerationsolver::Output& cgs_output)
     {
         Cost bound = std::ceil(cgs_output.bound - FFOT_TOL);
-        algorithm_formatter.update_bound(bound, "");
+        algorithm_formatter.update_bound(retrieve_bound(parameters, bound), "");
 
         if (cgs_output.solution.columns().size() > 0) {
-            Solution solution = columns2solution(instance, cgs_output.solution.columns());
-            algorithm_formatter.update_solution(solution, "");
+            Solution solution = columns2solution(model_instance, cgs_output.solution.columns());
+            algorithm_formatter.update_solution(retrieve_solution(parameters, solution), "");
         }
     };
     auto cgsg_output = columngenerationsolver::greedy(model, cgsg_parameters);
@@ -311,7 +464,14 @@ const ColumnGenerationHeuristicLimitedDiscrepancySearchOutput generalizedassignm
     algorithm_formatter.start("Column generation heuristic - limited discrepancy search");
     algorithm_formatter.print_header();
 
-    columngenerationsolver::Model model = get_model(instance);
+    const Instance& model_instance = get_model_instance(instance, parameters);
+    if (no_better_solution(parameters, algorithm_formatter)) {
+        algorithm_formatter.end();
+        return output;
+    }
+
+    KnapsackSubproblems knapsack_subproblems(model_instance);
+    columngenerationsolver::Model model = get_model(model_instance, knapsack_subproblems, parameters);
     columngenerationsolver::LimitedDiscrepancySearchParameters cgslds_parameters;
     cgslds_parameters.verbosity_level = 0;
     cgslds_parameters.timer = parameters.timer;
@@ -319,7 +479,7 @@ const ColumnGenerationHeuristicLimitedDiscrepancySearchOutput generalizedassignm
         = columngenerationsolver::s2lps(parameters.linear_programming_solver);
     cgslds_parameters.column_generation_parameters.self_adjusting_wentges_smoothing = true;
     cgslds_parameters.column_generation_parameters.automatic_directional_smoothing = true;
-    cgslds_parameters.new_solution_callback = [&instance, &algorithm_formatter](
+    cgslds_parameters.new_solution_callback = [&model_instance, &parameters, &algorithm_formatter](
                 const columngenerationsolver::Output& cgs_output)
         {
             const columngenerationsolver::LimitedDiscrepancySearchOutput& cgslds_output
@@ -328,12 +488,13 @@ const ColumnGenerationHeuristicLimitedDiscrepancySearchOutput generalizedassignm
             ss << "node " << cgslds_output.number_of_nodes;
             if (cgslds_output.solution.feasible()) {
                 ss << " discrepancy " << cgslds_output.maximum_discrepancy;
+                Solution solution = columns2solution(model_instance, cgslds_output.solution.columns());
                 algorithm_formatter.update_solution(
-                        columns2solution(instance, cgslds_output.solution.columns()),
+                        retrieve_solution(parameters, solution),
                         ss.str());
             }
             Cost bound = std::ceil(cgslds_output.bound - FFOT_TOL);
-            algorithm_formatter.update_bound(bound, ss.str());
+            algorithm_formatter.update_bound(retrieve_bound(parameters, bound), ss.str());
         };
 
     auto cgslds_output = columngenerationsolver::limited_discrepancy_search(
@@ -3,84 +3,108 @@
 #include "generalizedassignmentsolver/algorithm_formatter.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
 #include <vector>
 
 using namespace generalizedassignmentsolver;
 
-std::vector<std::vector<double>> compute_desirability(
+namespace
+{
+
+void compute_item_desirability(
         const Instance& instance,
-        std::string str)
+        const std::string& str,
+        ItemIdx item_id,
+        std::vector<double>& desirability)
 {
-    std::vector<std::vector<double>> desirability(
-            instance.number_of_items(),
-            std::vector<double>(instance.number_of_agents(), 0));
+    desirability.resize(instance.number_of_agents());
 
     if (str == "cij") {
-        for (ItemIdx item_id = 0;
-                item_id < instance.number_of_items();
-                ++item_id) {
-            for (AgentIdx agent_id = 0;
-                    agent_id < instance.number_of_agents();
-                    ++agent_id) {
-                desirability[item_id][agent_id] = instance.cost(item_id, agent_id);
-            }
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            desirability[agent_id] = instance.cost(item_id, agent_id);
         }
 
     } else if (str == "wij") {
-        for (ItemIdx item_id = 0;
-                item_id < instance.number_of_items();
-                ++item_id) {
-            for (AgentIdx agent_id = 0;
-                    agent_id < instance.number_of_agents();
-                    ++agent_id) {
-                desirability[item_id][agent_id] = instance.weight(item_id, agent_id);
-            }
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            desirability[agent_id] = instance.weight(item_id, agent_id);
         }
 
     } else if (str == "cij*wij") {
-        for (ItemIdx item_id = 0;
-                item_id < instance.number_of_items();
-                ++item_id) {
-            for (AgentIdx agent_id = 0;
-                    agent_id < instance.number_of_agents();
-                    ++agent_id) {
-                desirability[item_id][agent_id]
-                    = instance.cost(item_id, agent_id)
-                    * instance.cost(item_id, agent_id);
-            }
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            desirability[agent_id]
+                = instance.cost(item_id, agent_id)
+                * instance.cost(item_id, agent_id);
         }
 
     } else if (str == "-pij/wij") {
-        for (ItemIdx item_id = 0;
-                item_id < instance.number_of_items();
-                ++item_id) {
-            for (AgentIdx agent_id = 0;
-                    agent_id < instance.number_of_agents();
-                    ++agent_id) {
-                desirability[item_id][agent_id]
-                    = -(double)instance.profit(item_id, agent_id)
-                    / instance.weight(item_id, agent_id);
-            }
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            desirability[agent_id]
+                = -(double)instance.profit(item_id, agent_id)
+                / instance.weight(item_id, agent_id);
         }
 
     } else if (str == "wij/ti") {
-        for (ItemIdx item_id = 0;
-                item_id < instance.number_of_items();
-                ++item_id) {
-            for (AgentIdx agent_id = 0;
-                    agent_id < instance.number_of_agents();
-                    ++agent_id) {
-                desirability[item_id][agent_id]
-                    = (double)instance.weight(item_id, agent_id)
-                    / instance.capacity(agent_id);
-            }
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            desirability[agent_id]
+                = (double)instance.weight(item_id, agent_id)
+                / instance.capacity(agent_id);
         }
 
     } else {
 
         throw std::invalid_argument("Unknown desirability.");
     }
+}
+
+void sort_item_agents(
+        const std::vector<double>& desirability,
+        std::vector<AgentIdx>& agents)
+{
+    agents.resize(desirability.size());
+    std::iota(agents.begin(), agents.end(), 0);
+    sort(
+            agents.begin(),
+            agents.end(),
+            [&desirability](
+                AgentIdx agent_id_1,
+                AgentIdx agent_id_2) -> bool
+            {
+                return desirability[agent_id_1]
+                    < desirability[agent_id_2];
+            });
+}
+
+}
 
+std::vector<std::vector<double>> compute_desirability(
+        const Instance& instance,
+        std::string str)
+{
+    std::vector<std::vector<double>> desirability(instance.number_of_items());
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        compute_item_desirability(
+                instance,
+                str,
+                item_id,
+                desirability[item_id]);
+    }
     return desirability;
 }
 
@@ -150,28 +174,72 @@ std::vector<std::vector<AgentIdx>> generalizedassignmentsolver::greedy_regret_in
         const Instance& instance,
         const std::vector<std::vector<double>>& desirability)
 {
-    std::vector<std::vector<AgentIdx>> agents(
-            instance.number_of_items(),
-            std::vector<AgentIdx>(instance.number_of_agents()));
+    std::vector<std::vector<AgentIdx>> agents(instance.number_of_items());
     for (ItemIdx item_id = 0;
             item_id < instance.number_of_items();
             ++item_id) {
-        std::iota(agents[item_id].begin(), agents[item_id].end(), 0);
-        sort(
-                agents[item_id].begin(),
-                agents[item_id].end(),
-                [&desirability, &item_id](
-                    AgentIdx agent_id_1,
-                    AgentIdx agent_id_2) -> bool
-                {
-                    return desirability[item_id][agent_id_1]
-                        < desirability[item_id][agent_id_2];
-                });
+        sort_item_agents(desirability[item_id], agents[item_id]);
     }
 
     return agents;
 }
 
+namespace
+{
+
+/**
+ * Update the positions, in the sorted list of agents of an item, of the
+ * first and second feasible agents of the item, and return the regret of the
+ * item.
+ *
+ * Return -1 if the item can't be assigned to any agent.
+ */
+double update_regret(
+        const Solution& solution,
+        const std::vector<std::vector<double>>& desirability,
+        const std::vector<std::vector<AgentIdx>>& agents,
+        const std::vector<std::vector<int>>& fixed_alternatives,
+        ItemIdx item_id,
+        std::pair<AgentPos, AgentPos>& bests)
+{
+    const Instance& instance = solution.instance();
+    AgentPos& agent_pos_first = bests.first;
+    AgentPos& agent_pos_second = bests.second;
+
+    while (agent_pos_first < instance.number_of_agents()) {
+        AgentIdx agent_id = agents[item_id][agent_pos_first];
+        if (instance.weight(item_id, agent_id) > solution.remaining_capacity(agent_id)
+                || (!fixed_alternatives.empty()
+                    && fixed_alternatives[item_id][agent_id] != -1)) {
+            agent_pos_first++;
+            if (agent_pos_first == agent_pos_second)
+                agent_pos_second++;
+        } else {
+            break;
+        }
+    }
+    if (agent_pos_first == instance.number_of_agents())
+        return -1;
+
+    while (agent_pos_second < instance.number_of_agents()) {
+        AgentIdx agent_id = agents[item_id][agent_pos_second];
+        if (instance.weight(item_id, agent_id) > solution.remaining_capacity(agent_id)
+                || (!fixed_alternatives.empty()
+                    && fixed_alternatives[item_id][agent_id] != -1)) {
+            agent_pos_second++;
+        } else {
+            break;
+        }
+    }
+
+    return (agent_pos_second == instance.number_of_agents())?
+        std::numeric_limits<double>::infinity():
+        desirability[item_id][agents[item_id][agent_pos_second]]
+        - desirability[item_id][agents[item_id][agent_pos_first]];
+}
+
+}
+
 void generalizedassignmentsolver::greedy_regret(
         Solution& solution,
         const std::vector<std::vector<double>>& desirability,
@@ -179,54 +247,39 @@ void generalizedassignmentsolver::greedy_regret(
         const std::vector<std::vector<int>>& fixed_alternatives)
 {
     const Instance& instance = solution.instance();
-    std::vector<std::pair<AgentIdx, AgentIdx>> bests(instance.number_of_items(), {0, 1});
+    std::vector<std::pair<AgentPos, AgentPos>> bests(instance.number_of_items(), {0, 1});
 
-    while (!solution.full()) {
-        ItemIdx item_id_best = -1;
-        double f_best = -1;
-        for (ItemIdx item_id = 0; item_id < instance.number_of_items(); ++item_id) {
-            if (solution.agent(item_id) != -1)
-                continue;
+    // Unassigned items, sorted by id. Only these items are scanned at each
+    // step, so that completing an almost full solution is cheap.
+    std::vector<ItemIdx> unassigned_items;
+    for (ItemIdx item_id = 0; item_id < instance.number_of_items(); ++item_id)
+        if (solution.agent(item_id) == -1)
+            unassigned_items.push_back(item_id);
 
-            AgentIdx& agent_id_first = bests[item_id].first;
-            AgentIdx& agent_id_second = bests[item_id].second;
-
-            while (agent_id_first < instance.number_of_agents()) {
-                AgentIdx agent_id = agents[item_id][agent_id_first];
-                if (instance.weight(item_id, agent_id) > solution.remaining_capacity(agent_id)
-                        || (!fixed_alternatives.empty()
-                            && fixed_alternatives[item_id][agent_id] != -1)) {
-                    agent_id_first++;
-                    if (agent_id_first == agent_id_second)
-                        agent_id_second++;
-                } else {
-                    break;
-                }
-            }
-            if (agent_id_first == instance.number_of_agents())
+    while (!unassigned_items.empty()) {
+        ItemPos item_pos_best = -1;
+        double f_best = -1;
+        for (ItemPos item_pos = 0;
+                item_pos < (ItemPos)unassigned_items.size();
+                ++item_pos) {
+            ItemIdx item_id = unassigned_items[item_pos];
+            double f_curr = update_regret(
+                    solution,
+                    desirability,
+                    agents,
+                    fixed_alternatives,
+                    item_id,
+                    bests[item_id]);
+            if (f_curr < 0)
                 return;
-
-            while (agent_id_second < instance.number_of_agents()) {
-                AgentIdx agent_id = agents[item_id][agent_id_second];
-                if (instance.weight(item_id, agent_id) > solution.remaining_capacity(agent_id)
-                        || (!fixed_alternatives.empty()
-                            && fixed_alternatives[item_id][agent_id] != -1)) {
-                    agent_id_second++;
-                } else {
-                    break;
-                }
-            }
-
-            double f_curr = (agent_id_second == instance.number_of_agents())?
-                std::numeric_limits<double>::infinity():
-                desirability[item_id][agents[item_id][agent_id_second]]
-                - desirability[item_id][agents[item_id][agent_id_first]];
-            if (item_id_best == -1 || f_best < f_curr) {
+            if (item_pos_best == -1 || f_best < f_curr) {
                 f_best = f_curr;
-                item_id_best = item_id;
+                item_pos_best = item_pos;
             }
         }
+        ItemIdx item_id_best = unassigned_items[item_pos_best];
         solution.set(item_id_best, agents[item_id_best][bests[item_id_best].first]);
+        unassigned_items.erase(unassigned_items.begin() + item_pos_best);
     }
 }
 
@@ -319,6 +372,31 @@ void generalizedassignmentsolver::mthg_regret(
         nshift(solution);
 }
 
+Solution generalizedassignmentsolver::round_fractional_solution(
+        const Instance& instance,
+        const std::vector<std::vector<double>>& x)
+{
+    // Costs only break ties between equal values.
+    double cost_factor = 1e-3 / ((double)instance.maximum_cost() + 1);
+    std::vector<std::vector<double>> desirability(
+            instance.number_of_items(),
+            std::vector<double>(instance.number_of_agents()));
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            desirability[item_id][agent_id] = -x[item_id][agent_id]
+                + cost_factor * instance.cost(item_id, agent_id);
+        }
+    }
+    Solution solution(instance);
+    auto agents = greedy_regret_init(instance, desirability);
+    mthg_regret(solution, desirability, agents);
+    return solution;
+}
+
 const Output generalizedassignmentsolver::mthg_regret(
         const Instance& instance,
         const GreedyParameters& parameters)
@@ -337,3 +415,580 @@ const Output generalizedassignmentsolver::mthg_regret(
     algorithm_formatter.end();
     return output;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/**
+ * Run 'number_of_tasks' tasks on 'number_of_threads' threads.
+ *
+ * Each thread repeatedly picks the next task which has not been started yet.
+ */
+void run_tasks(
+        Counter number_of_threads,
+        Counter number_of_tasks,
+        const std::function<void(Counter)>& task)
+{
+    std::atomic<Counter> next_task_id(0);
+    auto worker = [&next_task_id, &number_of_tasks, &task]()
+    {
+        for (;;) {
+            Counter task_id = next_task_id++;
+            if (task_id >= number_of_tasks)
+                break;
+            task(task_id);
+        }
+    };
+
+    number_of_threads = (std::max)((Counter)1, (std::min)(number_of_threads, number_of_tasks));
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1; thread_id < number_of_threads; ++thread_id)
+        threads.push_back(std::thread(worker));
+    worker();
+    for (std::thread& thread: threads)
+        thread.join();
+}
+
+}
+
+const Output generalizedassignmentsolver::greedy_portfolio(
+        const Instance& instance,
+        const GreedyPortfolioParameters& parameters)
+{
+    Output output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Greedy portfolio");
+    algorithm_formatter.print_header();
+
+    std::vector<std::string> desirability_names = {
+        "cij", "wij", "cij*wij", "-pij/wij", "wij/ti"};
+    std::vector<std::string> variant_names = {
+        "greedy", "greedy-regret", "mthg", "mthg-regret"};
+    Counter number_of_desirabilities = desirability_names.size();
+    Counter number_of_variants = variant_names.size();
+
+    // Compute the desirabilities.
+    std::vector<std::vector<std::vector<double>>> desirabilities(number_of_desirabilities);
+    run_tasks(
+            parameters.number_of_threads,
+            number_of_desirabilities,
+            [&instance, &desirability_names, &desirabilities](Counter desirability_id)
+            {
+                desirabilities[desirability_id] = compute_desirability(
+                        instance,
+                        desirability_names[desirability_id]);
+            });
+
+    // Compute the sorted orders. Each one is shared by the greedy and the
+    // mthg variants.
+    std::vector<std::vector<std::pair<ItemIdx, AgentIdx>>> alternatives(number_of_desirabilities);
+    std::vector<std::vector<std::vector<AgentIdx>>> agents(number_of_desirabilities);
+    run_tasks(
+            parameters.number_of_threads,
+            2 * number_of_desirabilities,
+            [&instance, &desirabilities, &alternatives, &agents,
+                &number_of_desirabilities](Counter task_id)
+            {
+                Counter desirability_id = task_id % number_of_desirabilities;
+                if (task_id < number_of_desirabilities) {
+                    alternatives[desirability_id] = greedy_init(
+                            instance,
+                            desirabilities[desirability_id]);
+                } else {
+                    agents[desirability_id] = greedy_regret_init(
+                            instance,
+                            desirabilities[desirability_id]);
+                }
+            });
+
+    // Run all variants.
+    std::mutex mutex;
+    run_tasks(
+            parameters.number_of_threads,
+            number_of_desirabilities * number_of_variants,
+            [&instance, &parameters, &algorithm_formatter, &mutex,
+                &desirability_names, &variant_names, &number_of_desirabilities,
+                &desirabilities, &alternatives, &agents](Counter task_id)
+            {
+                if (parameters.timer.needs_to_end())
+                    return;
+                Counter variant_id = task_id / number_of_desirabilities;
+                Counter desirability_id = task_id % number_of_desirabilities;
+
+                Solution solution(instance);
+                switch (variant_id) {
+                case 0:
+                    greedy(solution, alternatives[desirability_id]);
+                    break;
+                case 1:
+                    greedy_regret(
+                            solution,
+                            desirabilities[desirability_id],
+                            agents[desirability_id]);
+                    break;
+                case 2:
+                    mthg(solution, alternatives[desirability_id]);
+                    break;
+                default:
+                    mthg_regret(
+                            solution,
+                            desirabilities[desirability_id],
+                            agents[desirability_id]);
+                    break;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                algorithm_formatter.update_solution(
+                        solution,
+                        variant_names[variant_id] + " " + desirability_names[desirability_id]);
+            });
+
+    algorithm_formatter.end();
+    return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/**
+ * Scratch buffers of a GRASP thread.
+ *
+ * They are allocated once per thread and reused by all its constructions.
+ */
+struct GraspWorkspace
+{
+    GraspWorkspace(const Instance& instance):
+        solution(instance),
+        bests(instance.number_of_items()) { }
+
+    /** Solution under construction. */
+    Solution solution;
+
+    /** For each item, positions of its first and second feasible agents. */
+    std::vector<std::pair<AgentPos, AgentPos>> bests;
+
+    /** Positions of the candidate alternatives. */
+    std::vector<Counter> alternative_positions;
+
+    /** Candidate items with their regret. */
+    std::vector<std::pair<double, ItemIdx>> candidates;
+};
+
+void greedy_randomized(
+        GraspWorkspace& workspace,
+        const std::vector<std::pair<ItemIdx, AgentIdx>>& alternatives,
+        Counter restricted_candidate_list_size,
+        std::mt19937_64& generator)
+{
+    Solution& solution = workspace.solution;
+    const Instance& instance = solution.instance();
+    auto is_candidate = [&solution, &instance](
+            const std::pair<ItemIdx, AgentIdx>& alternative)
+    {
+        return solution.agent(alternative.first) == -1
+            && solution.remaining_capacity(alternative.second)
+            >= instance.weight(alternative.first, alternative.second);
+    };
+
+    // Since capacities only decrease, an alternative which is not a
+    // candidate anymore never becomes a candidate again.
+    Counter alternative_pos_first = 0;
+    while (!solution.full()) {
+        while (alternative_pos_first < (Counter)alternatives.size()
+                && !is_candidate(alternatives[alternative_pos_first])) {
+            alternative_pos_first++;
+        }
+        if (alternative_pos_first == (Counter)alternatives.size())
+            return;
+
+        workspace.alternative_positions.clear();
+        for (Counter alternative_pos = alternative_pos_first;
+                alternative_pos < (Counter)alternatives.size()
+                && (Counter)workspace.alternative_positions.size() < restricted_candidate_list_size;
+                ++alternative_pos) {
+            if (is_candidate(alternatives[alternative_pos]))
+                workspace.alternative_positions.push_back(alternative_pos);
+        }
+
+        std::uniform_int_distribution<Counter> d(0, workspace.alternative_positions.size() - 1);
+        const auto& alternative = alternatives[workspace.alternative_positions[d(generator)]];
+        solution.set(alternative.first, alternative.second);
+    }
+}
+
+void greedy_regret_randomized(
+        GraspWorkspace& workspace,
+        const std::vector<std::vector<double>>& desirability,
+        const std::vector<std::vector<AgentIdx>>& agents,
+        Counter restricted_candidate_list_size,
+        std::mt19937_64& generator)
+{
+    Solution& solution = workspace.solution;
+    const Instance& instance = solution.instance();
+    std::fill(workspace.bests.begin(), workspace.bests.end(), std::pair<AgentPos, AgentPos>(0, 1));
+
+    while (!solution.full()) {
+        workspace.candidates.clear();
+        for (ItemIdx item_id = 0; item_id < instance.number_of_items(); ++item_id) {
+            if (solution.agent(item_id) != -1)
+                continue;
+            double f = update_regret(
+                    solution,
+                    desirability,
+                    agents,
+                    {},
+                    item_id,
+                    workspace.bests[item_id]);
+            if (f < 0)
+                return;
+            workspace.candidates.push_back({f, item_id});
+        }
+
+        // Keep the candidates with the largest regrets.
+        if ((Counter)workspace.candidates.size() > restricted_candidate_list_size) {
+            std::nth_element(
+                    workspace.candidates.begin(),
+                    workspace.candidates.begin() + restricted_candidate_list_size - 1,
+                    workspace.candidates.end(),
+                    std::greater<std::pair<double, ItemIdx>>());
+            workspace.candidates.resize(restricted_candidate_list_size);
+        }
+
+        std::uniform_int_distribution<Counter> d(0, workspace.candidates.size() - 1);
+        ItemIdx item_id = workspace.candidates[d(generator)].second;
+        solution.set(item_id, agents[item_id][workspace.bests[item_id].first]);
+    }
+}
+
+}
+
+const GraspOutput generalizedassignmentsolver::grasp(
+        const Instance& instance,
+        const GraspParameters& parameters)
+{
+    GraspOutput output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("GRASP");
+    algorithm_formatter.print_header();
+
+    if (parameters.construction != "greedy"
+            && parameters.construction != "greedy-regret") {
+        throw std::invalid_argument(
+                "Unknown construction \"" + parameters.construction + "\".");
+    }
+    Counter restricted_candidate_list_size = (std::max)(
+            (Counter)1,
+            parameters.restricted_candidate_list_size);
+
+    auto desirability = compute_desirability(instance, parameters.desirability);
+    std::vector<std::pair<ItemIdx, AgentIdx>> alternatives;
+    std::vector<std::vector<AgentIdx>> agents;
+    if (parameters.construction == "greedy") {
+        alternatives = greedy_init(instance, desirability);
+    } else {
+        agents = greedy_regret_init(instance, desirability);
+    }
+
+    // Cost of the best solution found so far. It is checked without locking
+    // so that threads only synchronize on improvements.
+    std::atomic<Cost> best_cost(std::numeric_limits<Cost>::max());
+    std::atomic<Counter> number_of_iterations(0);
+    std::mutex mutex;
+    run_tasks(
+            parameters.number_of_threads,
+            parameters.number_of_threads,
+            [&instance, &parameters, &algorithm_formatter, &mutex,
+                &restricted_candidate_list_size, &desirability,
+                &alternatives, &agents, &best_cost,
+                &number_of_iterations](Counter thread_id)
+            {
+                std::mt19937_64 generator(parameters.seed + thread_id);
+                GraspWorkspace workspace(instance);
+                Solution& solution = workspace.solution;
+                for (;;) {
+                    if (parameters.timer.needs_to_end())
+                        break;
+                    Counter iteration = number_of_iterations++;
+                    if (parameters.maximum_number_of_iterations != -1
+                            && iteration >= parameters.maximum_number_of_iterations) {
+                        number_of_iterations--;
+                        break;
+                    }
+
+                    // Construct.
+                    for (ItemIdx item_id = 0;
+                            item_id < instance.number_of_items();
+                            ++item_id) {
+                        solution.set(item_id, -1);
+                    }
+                    if (parameters.construction == "greedy") {
+                        greedy_randomized(
+                                workspace,
+                                alternatives,
+                                restricted_candidate_list_size,
+                                generator);
+                    } else {
+                        greedy_regret_randomized(
+                                workspace,
+                                desirability,
+                                agents,
+                                restricted_candidate_list_size,
+                                generator);
+                    }
+                    if (!solution.feasible())
+                        continue;
+
+                    // Improve.
+                    nshift(solution);
+
+                    // Update best solution.
+                    Cost cost = solution.cost();
+                    Cost cost_best = best_cost.load();
+                    while (cost < cost_best
+                            && !best_cost.compare_exchange_weak(cost_best, cost)) { }
+                    if (cost >= cost_best)
+                        continue;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    algorithm_formatter.update_solution(
+                            solution,
+                            "thread " + std::to_string(thread_id)
+                            + " it " + std::to_string(iteration));
+                }
+            });
+
+    output.number_of_iterations = number_of_iterations;
+    algorithm_formatter.end();
+    return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////// Greedy repair /////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+GreedyRepairData generalizedassignmentsolver::greedy_repair_init(
+        const Instance& instance,
+        const std::string& desirability)
+{
+    GreedyRepairData data;
+    data.desirability_name = desirability;
+    data.desirability = compute_desirability(instance, desirability);
+    data.agents = greedy_regret_init(instance, data.desirability);
+    return data;
+}
+
+Solution generalizedassignmentsolver::greedy_repair(
+        const Instance& instance,
+        const Solution& previous_solution,
+        const InstanceDelta& delta,
+        GreedyRepairData& data)
+{
+    const Instance& previous_instance = previous_solution.instance();
+    ItemIdx number_of_previous_items = previous_instance.number_of_items();
+    if (instance.number_of_items() != number_of_previous_items
+            - (ItemIdx)delta.removed_items.size()
+            + delta.number_of_new_items) {
+        throw std::invalid_argument(
+                "Inconsistent number of items in instance delta.");
+    }
+    if (instance.number_of_agents() != previous_instance.number_of_agents()) {
+        throw std::invalid_argument(
+                "Inconsistent number of agents in instance delta.");
+    }
+
+    std::vector<ItemIdx> removed_items = delta.removed_items;
+    std::sort(removed_items.begin(), removed_items.end());
+
+    // Keep the assignments and the helper structures of the remaining items.
+    Solution solution(instance);
+    ItemIdx item_id = 0;
+    ItemPos removed_item_pos = 0;
+    for (ItemIdx previous_item_id = 0;
+            previous_item_id < number_of_previous_items;
+            ++previous_item_id) {
+        if (removed_item_pos < (ItemPos)removed_items.size()
+                && removed_items[removed_item_pos] == previous_item_id) {
+            removed_item_pos++;
+            continue;
+        }
+        if (item_id != previous_item_id) {
+            data.desirability[item_id] = std::move(data.desirability[previous_item_id]);
+            data.agents[item_id] = std::move(data.agents[previous_item_id]);
+        }
+        AgentIdx agent_id = previous_solution.agent(previous_item_id);
+        if (agent_id != -1)
+            solution.set(item_id, agent_id);
+        item_id++;
+    }
+
+    // Compute the helper structures of the new items.
+    data.desirability.resize(instance.number_of_items());
+    data.agents.resize(instance.number_of_items());
+    for (; item_id < instance.number_of_items(); ++item_id) {
+        compute_item_desirability(
+                instance,
+                data.desirability_name,
+                item_id,
+                data.desirability[item_id]);
+        sort_item_agents(data.desirability[item_id], data.agents[item_id]);
+    }
+
+    // Update the helper structures of the remaining items if their
+    // desirability depends on the capacities.
+    if (data.desirability_name == "wij/ti" && !delta.modified_capacities.empty()) {
+        ItemIdx number_of_remaining_items = number_of_previous_items
+            - (ItemIdx)removed_items.size();
+        for (ItemIdx item_id = 0;
+                item_id < number_of_remaining_items;
+                ++item_id) {
+            std::vector<double>& item_desirability = data.desirability[item_id];
+            for (AgentIdx agent_id: delta.modified_capacities) {
+                item_desirability[agent_id]
+                    = (double)instance.weight(item_id, agent_id)
+                    / instance.capacity(agent_id);
+            }
+            // Few values have changed, insertion sort restores the order in
+            // almost linear time.
+            std::vector<AgentIdx>& item_agents = data.agents[item_id];
+            for (AgentPos agent_pos = 1;
+                    agent_pos < instance.number_of_agents();
+                    ++agent_pos) {
+                AgentIdx agent_id = item_agents[agent_pos];
+                AgentPos agent_pos_2 = agent_pos;
+                for (; agent_pos_2 > 0
+                        && item_desirability[item_agents[agent_pos_2 - 1]]
+                        > item_desirability[agent_id];
+                        --agent_pos_2) {
+                    item_agents[agent_pos_2] = item_agents[agent_pos_2 - 1];
+                }
+                item_agents[agent_pos_2] = agent_id;
+            }
+        }
+    }
+
+    // Unassign the modified items and recompute their helper structures.
+    for (ItemIdx item_id: delta.modified_items) {
+        solution.set(item_id, -1);
+        compute_item_desirability(
+                instance,
+                data.desirability_name,
+                item_id,
+                data.desirability[item_id]);
+        sort_item_agents(data.desirability[item_id], data.agents[item_id]);
+    }
+
+    // Unassign the least desirable items of the agents whose capacity is
+    // exceeded.
+    std::vector<std::vector<ItemIdx>> overloaded_agents_items(instance.number_of_agents());
+    bool has_overloaded_agent = false;
+    for (AgentIdx agent_id = 0;
+            agent_id < instance.number_of_agents();
+            ++agent_id) {
+        if (solution.overcapacity(agent_id) > 0)
+            has_overloaded_agent = true;
+    }
+    if (has_overloaded_agent) {
+        for (ItemIdx item_id = 0;
+                item_id < instance.number_of_items();
+                ++item_id) {
+            AgentIdx agent_id = solution.agent(item_id);
+            if (agent_id != -1 && solution.overcapacity(agent_id) > 0)
+                overloaded_agents_items[agent_id].push_back(item_id);
+        }
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            std::vector<ItemIdx>& items = overloaded_agents_items[agent_id];
+            std::sort(
+                    items.begin(),
+                    items.end(),
+                    [&data, agent_id](
+                        ItemIdx item_id_1,
+                        ItemIdx item_id_2) -> bool
+                    {
+                        return data.desirability[item_id_1][agent_id]
+                            > data.desirability[item_id_2][agent_id];
+                    });
+            for (ItemIdx item_id: items) {
+                if (solution.overcapacity(agent_id) == 0)
+                    break;
+                solution.set(item_id, -1);
+            }
+        }
+    }
+
+    // Insert the unassigned items.
+    greedy_regret(solution, data.desirability, data.agents);
+
+    return solution;
+}
+
+const Output generalizedassignmentsolver::greedy_repair(
+        const Instance& instance,
+        const Solution& previous_solution,
+        const GreedyParameters& parameters)
+{
+    Output output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Greedy repair");
+    algorithm_formatter.print_header();
+
+    const Instance& previous_instance = previous_solution.instance();
+    if (instance.number_of_agents() != previous_instance.number_of_agents()) {
+        throw std::invalid_argument(
+                "generalizedassignmentsolver::greedy_repair: "
+                "the previous instance must have the same agents.");
+    }
+
+    // Compute the delta.
+    InstanceDelta delta;
+    for (ItemIdx item_id = instance.number_of_items();
+            item_id < previous_instance.number_of_items();
+            ++item_id) {
+        delta.removed_items.push_back(item_id);
+    }
+    delta.number_of_new_items = (std::max)(
+            (ItemIdx)0,
+            instance.number_of_items() - previous_instance.number_of_items());
+    for (AgentIdx agent_id = 0;
+            agent_id < instance.number_of_agents();
+            ++agent_id) {
+        if (instance.capacity(agent_id) != previous_instance.capacity(agent_id))
+            delta.modified_capacities.push_back(agent_id);
+    }
+    for (ItemIdx item_id = 0;
+            item_id < (std::min)(
+                instance.number_of_items(),
+                previous_instance.number_of_items());
+            ++item_id) {
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            if (instance.weight(item_id, agent_id) != previous_instance.weight(item_id, agent_id)
+                    || instance.cost(item_id, agent_id) != previous_instance.cost(item_id, agent_id)) {
+                delta.modified_items.push_back(item_id);
+                break;
+            }
+        }
+    }
+
+    GreedyRepairData data = greedy_repair_init(
+            previous_instance,
+            parameters.desirability);
+    Solution solution = greedy_repair(
+            instance,
+            previous_solution,
+            delta,
+            data);
+    algorithm_formatter.update_solution(solution, "");
+
+    algorithm_formatter.end();
+    return output;
+}
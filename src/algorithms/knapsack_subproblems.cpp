@@ -0,0 +1,87 @@
+#include "generalizedassignmentsolver/algorithms/knapsack_subproblems.hpp"
+
+#include "knapsacksolver/instance_builder.hpp"
+#include "knapsacksolver/algorithms/dynamic_programming_primal_dual.hpp"
+
+using namespace generalizedassignmentsolver;
+
+KnapsackSubproblems::KnapsackSubproblems(const Instance& instance):
+    instance_(instance),
+    subproblems_(instance.number_of_agents())
+{
+    for (AgentIdx agent_id = 0;
+            agent_id < instance.number_of_agents();
+            ++agent_id) {
+        set_subproblem(
+                agent_id,
+                instance.capacity(agent_id),
+                [](ItemIdx) { return false; });
+    }
+}
+
+void KnapsackSubproblems::reserve(AgentSubproblem& subproblem)
+{
+    std::size_t size = subproblem.items.size();
+    subproblem.kp_to_gap.reserve(size);
+    subproblem.selected_items.reserve(size);
+}
+
+void KnapsackSubproblems::set_subproblem(
+        AgentIdx agent_id,
+        Weight capacity,
+        const std::function<bool (ItemIdx)>& excluded_items)
+{
+    AgentSubproblem& subproblem = subproblems_[agent_id];
+    subproblem.capacity = capacity;
+    subproblem.items.reserve(instance_.number_of_items());
+    subproblem.items.clear();
+    for (ItemIdx item_id = 0;
+            item_id < instance_.number_of_items();
+            ++item_id) {
+        if (instance_.weight(item_id, agent_id) > capacity)
+            continue;
+        if (excluded_items(item_id))
+            continue;
+        subproblem.items.push_back(item_id);
+    }
+    reserve(subproblem);
+}
+
+const std::vector<ItemIdx>& KnapsackSubproblems::solve(
+        AgentIdx agent_id,
+        const std::vector<double>& item_values,
+        ItemIdx item_values_offset)
+{
+    AgentSubproblem& subproblem = subproblems_[agent_id];
+
+    // Build knapsack instance.
+    knapsacksolver::InstanceFromFloatProfitsBuilder kp_instance_builder;
+    kp_instance_builder.set_capacity(subproblem.capacity);
+    subproblem.kp_to_gap.clear();
+    for (ItemIdx item_id: subproblem.items) {
+        double profit = item_values[item_values_offset + item_id]
+            - instance_.cost(item_id, agent_id);
+        if (profit <= 0)
+            continue;
+        kp_instance_builder.add_item(profit, instance_.weight(item_id, agent_id));
+        subproblem.kp_to_gap.push_back(item_id);
+    }
+    const knapsacksolver::Instance kp_instance = kp_instance_builder.build();
+
+    // Solve knapsack instance.
+    knapsacksolver::DynamicProgrammingPrimalDualParameters kp_parameters;
+    kp_parameters.verbosity_level = 0;
+    auto kp_output = knapsacksolver::dynamic_programming_primal_dual(
+            kp_instance,
+            kp_parameters);
+
+    // Retrieve selected items.
+    subproblem.selected_items.clear();
+    for (knapsacksolver::ItemId kp_item_id = 0;
+            kp_item_id < kp_instance.number_of_items();
+            ++kp_item_id) {
+        if (kp_output.solution.contains(kp_item_id))
+            subproblem.selected_items.push_back(subproblem.kp_to_gap[kp_item_id]);
+    }
+    return subproblem.selected_items;
+}
@@ -1,5 +1,7 @@
 #include "generalizedassignmentsolver/algorithms/lagrangian_relaxation.hpp"
 
+#include "generalizedassignmentsolver/algorithms/knapsack_subproblems.hpp"
+#include "generalizedassignmentsolver/algorithms/greedy.hpp"
 #include "generalizedassignmentsolver/algorithm_formatter.hpp"
 
 #if KNITRO_FOUND
@@ -12,16 +14,633 @@
 #include "mathoptsolverscmake/mathopt_conicbundle.hpp"
 #endif
 
-#include "knapsacksolver/instance_builder.hpp"
-#include "knapsacksolver/algorithms/dynamic_programming_primal_dual.hpp"
-//#include "knapsacksolver/algorithms/dynamic_programming_bellman.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define GENERALIZEDASSIGNMENTSOLVER_X86_DISPATCH
+#include <immintrin.h>
+#endif
 
 using namespace generalizedassignmentsolver;
 
+////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////// Dual optimizers ////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/**
+ * Evaluations of the dual function by the native dual optimizers.
+ *
+ * It keeps track of the best bound, reports it through the algorithm
+ * formatter, and checks the stopping criteria.
+ */
+class LagrangianDualSearch
+{
+
+public:
+
+    LagrangianDualSearch(
+            const mathoptsolverscmake::MathOptModel& model,
+            const LagrangianRelaxationParameters& parameters,
+            LagrangianRelaxationOutput& output,
+            AlgorithmFormatter& algorithm_formatter):
+        model_(model),
+        parameters_(parameters),
+        output_(output),
+        algorithm_formatter_(algorithm_formatter) { }
+
+    /** Evaluate the dual function and update the best bound. */
+    mathoptsolverscmake::BlackBoxFunctionOutput evaluate(
+            const std::vector<double>& multipliers)
+    {
+        mathoptsolverscmake::BlackBoxFunctionOutput function_output
+            = model_.objective_function(multipliers);
+        output_.number_of_iterations++;
+        double value = function_output.objective_value;
+        if (value > bound_ + 1e-6 * (std::max)(1.0, std::abs(bound_)))
+            number_of_iterations_without_improvement_ = 0;
+        else
+            number_of_iterations_without_improvement_++;
+        if (value > bound_) {
+            bound_ = value;
+            output_.multipliers = multipliers;
+            std::stringstream ss;
+            ss << "iteration " << output_.number_of_iterations;
+            algorithm_formatter_.update_bound(std::ceil(bound_ - FFOT_TOL), ss.str());
+        }
+        return function_output;
+    }
+
+    /** Get the best bound. */
+    double bound() const { return bound_; }
+
+    /** Get the multipliers of the best bound. */
+    const std::vector<double>& multipliers() const { return output_.multipliers; }
+
+    /** Return 'true' iff the search must stop. */
+    bool needs_to_end() const
+    {
+        if (parameters_.timer.needs_to_end())
+            return true;
+        if (parameters_.maximum_number_of_iterations != -1
+                && output_.number_of_iterations >= parameters_.maximum_number_of_iterations)
+            return true;
+        if (number_of_iterations_without_improvement_
+                >= parameters_.maximum_number_of_iterations_without_improvement)
+            return true;
+        // The bound reached the value of the best known solution.
+        if (output_.solution.feasible()
+                && output_.bound >= output_.solution.objective_value())
+            return true;
+        return false;
+    }
+
+    /** Project multipliers on the bounds of the variables. */
+    void project(std::vector<double>& multipliers) const
+    {
+        for (std::size_t variable_id = 0;
+                variable_id < multipliers.size();
+                ++variable_id) {
+            multipliers[variable_id] = (std::min)(
+                    model_.variables_upper_bounds[variable_id],
+                    (std::max)(
+                        model_.variables_lower_bounds[variable_id],
+                        multipliers[variable_id]));
+        }
+    }
+
+    /**
+     * Project a gradient on the directions which are feasible from some
+     * multipliers.
+     */
+    void project_gradient(
+            const std::vector<double>& multipliers,
+            std::vector<double>& gradient) const
+    {
+        for (std::size_t variable_id = 0;
+                variable_id < multipliers.size();
+                ++variable_id) {
+            if ((gradient[variable_id] < 0
+                        && multipliers[variable_id] <= model_.variables_lower_bounds[variable_id])
+                    || (gradient[variable_id] > 0
+                        && multipliers[variable_id] >= model_.variables_upper_bounds[variable_id])) {
+                gradient[variable_id] = 0;
+            }
+        }
+    }
+
+private:
+
+    /** Model. */
+    const mathoptsolverscmake::MathOptModel& model_;
+
+    /** Parameters. */
+    const LagrangianRelaxationParameters& parameters_;
+
+    /** Output. */
+    LagrangianRelaxationOutput& output_;
+
+    /** Algorithm formatter. */
+    AlgorithmFormatter& algorithm_formatter_;
+
+    /** Best bound. */
+    double bound_ = -std::numeric_limits<double>::infinity();
+
+    /** Number of consecutive evaluations without improving the bound. */
+    Counter number_of_iterations_without_improvement_ = 0;
+
+};
+
+double squared_norm(const std::vector<double>& vector)
+{
+    double norm = 0;
+    for (double value: vector)
+        norm += value * value;
+    return norm;
+}
+
+double dot_product(
+        const std::vector<double>& vector_1,
+        const std::vector<double>& vector_2)
+{
+    double product = 0;
+    for (std::size_t pos = 0; pos < vector_1.size(); ++pos)
+        product += vector_1[pos] * vector_2[pos];
+    return product;
+}
+
+/**
+ * Subgradient method with Polyak steps.
+ *
+ * The step towards a target value 'bound + delta' is
+ * '(target - f(multipliers)) / ||g||^2 * g'. 'delta' is increased when the
+ * target is reached and halved, and the search restarted from the best
+ * multipliers, after some iterations without improvement.
+ */
+void lagrangian_dual_subgradient(
+        const mathoptsolverscmake::MathOptModel& model,
+        LagrangianDualSearch& search)
+{
+    const Counter number_of_iterations_before_halving = 10;
+
+    std::vector<double> multipliers = model.variables_initial_values;
+    search.project(multipliers);
+    mathoptsolverscmake::BlackBoxFunctionOutput function_output
+        = search.evaluate(multipliers);
+    double delta = 0.1 * (std::max)(1.0, std::abs(function_output.objective_value));
+    Counter number_of_iterations_without_improvement = 0;
+    while (!search.needs_to_end()) {
+        search.project_gradient(multipliers, function_output.gradient);
+        double norm = squared_norm(function_output.gradient);
+        // The multipliers are optimal.
+        if (norm == 0)
+            break;
+
+        double target = search.bound() + delta;
+        double step = (target - function_output.objective_value) / norm;
+        for (std::size_t variable_id = 0;
+                variable_id < multipliers.size();
+                ++variable_id) {
+            multipliers[variable_id] += step * function_output.gradient[variable_id];
+        }
+        search.project(multipliers);
+        double bound_previous = search.bound();
+        function_output = search.evaluate(multipliers);
+
+        if (function_output.objective_value > bound_previous) {
+            number_of_iterations_without_improvement = 0;
+            if (function_output.objective_value >= target)
+                delta *= 1.5;
+        } else {
+            number_of_iterations_without_improvement++;
+            if (number_of_iterations_without_improvement >= number_of_iterations_before_halving) {
+                number_of_iterations_without_improvement = 0;
+                delta /= 2;
+                if (delta < 1e-6 * (std::max)(1.0, std::abs(search.bound())))
+                    break;
+                multipliers = search.multipliers();
+                function_output = search.evaluate(multipliers);
+            }
+        }
+    }
+}
+
+/**
+ * Proximal bundle method.
+ *
+ * The cutting-plane model of the dual function built from the gradients
+ * of the previous evaluations, penalized by '(u / 2) * ||x - center||^2',
+ * is maximized by solving the dual of the subproblem, a small quadratic
+ * program over the simplex, with pairwise coordinate steps. The center
+ * moves if the dual function increases by at least a fraction of the
+ * increase predicted by the model (serious step); otherwise, the new cut
+ * enriches the model (null step). When the bundle is full, its cuts are
+ * replaced by their aggregation.
+ *
+ * The bounds of the variables are handled by projecting the step, which is
+ * exact for the free multipliers of the assignment constraints.
+ */
+void lagrangian_dual_bundle(
+        const mathoptsolverscmake::MathOptModel& model,
+        LagrangianDualSearch& search)
+{
+    const Counter maximum_bundle_size = 50;
+    const double serious_step_fraction = 0.1;
+    const double u_min = 1e-12;
+    const double u_max = 1e12;
+
+    std::vector<double> center = model.variables_initial_values;
+    search.project(center);
+    mathoptsolverscmake::BlackBoxFunctionOutput function_output
+        = search.evaluate(center);
+    double value_center = function_output.objective_value;
+
+    // Cuts 'f(x) <= values[k] + gradients[k] * (x - center)'.
+    std::vector<std::vector<double>> gradients = {function_output.gradient};
+    std::vector<double> values = {value_center};
+    // Gram matrix of the gradients.
+    std::vector<std::vector<double>> gram = {{squared_norm(function_output.gradient)}};
+    // Solution of the quadratic program.
+    std::vector<double> alphas = {1.0};
+
+    double gradient_norm = gram[0][0];
+    if (gradient_norm == 0)
+        return;
+    double u = gradient_norm / (0.1 * (std::max)(1.0, std::abs(value_center)));
+
+    std::vector<double> step(center.size());
+    std::vector<double> multipliers(center.size());
+    while (!search.needs_to_end()) {
+        Counter bundle_size = values.size();
+
+        // Solve the dual of the proximal subproblem:
+        // min_{alpha in simplex} sum_k alpha_k values_k
+        //     + (1 / 2u) ||sum_k alpha_k gradients_k||^2
+        std::vector<double> gram_alphas(bundle_size, 0);
+        for (Counter k = 0; k < bundle_size; ++k)
+            for (Counter l = 0; l < bundle_size; ++l)
+                gram_alphas[k] += gram[k][l] * alphas[l];
+        for (Counter qp_iteration = 0;
+                qp_iteration < 100 * bundle_size;
+                ++qp_iteration) {
+            Counter k_min = -1;
+            Counter l_max = -1;
+            double gradient_min = std::numeric_limits<double>::infinity();
+            double gradient_max = -std::numeric_limits<double>::infinity();
+            for (Counter k = 0; k < bundle_size; ++k) {
+                double gradient = values[k] + gram_alphas[k] / u;
+                if (gradient < gradient_min) {
+                    gradient_min = gradient;
+                    k_min = k;
+                }
+                if (alphas[k] > 0 && gradient > gradient_max) {
+                    gradient_max = gradient;
+                    l_max = k;
+                }
+            }
+            double gap = gradient_max - gradient_min;
+            if (k_min == l_max
+                    || gap <= 1e-12 * (std::max)(1.0, std::abs(value_center))) {
+                break;
+            }
+            double curvature = (gram[k_min][k_min] + gram[l_max][l_max]
+                    - 2 * gram[k_min][l_max]) / u;
+            double t = (curvature > 0)?
+                (std::min)(alphas[l_max], gap / curvature):
+                alphas[l_max];
+            alphas[k_min] += t;
+            alphas[l_max] -= t;
+            for (Counter k = 0; k < bundle_size; ++k)
+                gram_alphas[k] += t * (gram[k][k_min] - gram[k][l_max]);
+        }
+
+        // Candidate multipliers.
+        std::fill(step.begin(), step.end(), 0);
+        for (Counter k = 0; k < bundle_size; ++k) {
+            if (alphas[k] == 0)
+                continue;
+            for (std::size_t variable_id = 0; variable_id < step.size(); ++variable_id)
+                step[variable_id] += alphas[k] * gradients[k][variable_id] / u;
+        }
+        for (std::size_t variable_id = 0; variable_id < step.size(); ++variable_id)
+            multipliers[variable_id] = center[variable_id] + step[variable_id];
+        search.project(multipliers);
+        for (std::size_t variable_id = 0; variable_id < step.size(); ++variable_id)
+            step[variable_id] = multipliers[variable_id] - center[variable_id];
+
+        // Increase predicted by the model.
+        double value_model = std::numeric_limits<double>::infinity();
+        for (Counter k = 0; k < bundle_size; ++k)
+            value_model = (std::min)(value_model, values[k] + dot_product(gradients[k], step));
+        double predicted_increase = value_model - value_center;
+        // The center is optimal for the tolerance.
+        if (predicted_increase <= 1e-9 * (std::max)(1.0, std::abs(value_center)))
+            break;
+
+        function_output = search.evaluate(multipliers);
+        double increase = function_output.objective_value - value_center;
+
+        // Compress the bundle into its aggregated cut.
+        if (bundle_size >= maximum_bundle_size) {
+            std::vector<double> gradient_aggregated(center.size(), 0);
+            double value_aggregated = 0;
+            for (Counter k = 0; k < bundle_size; ++k) {
+                value_aggregated += alphas[k] * values[k];
+                for (std::size_t variable_id = 0; variable_id < center.size(); ++variable_id)
+                    gradient_aggregated[variable_id] += alphas[k] * gradients[k][variable_id];
+            }
+            gradients = {gradient_aggregated};
+            values = {value_aggregated};
+            gram = {{squared_norm(gradient_aggregated)}};
+            alphas = {1.0};
+        }
+
+        // Add the new cut, expressed at the current center.
+        double value_new = function_output.objective_value
+            - dot_product(function_output.gradient, step);
+        std::vector<double> gram_row(values.size() + 1);
+        for (Counter k = 0; k < (Counter)values.size(); ++k) {
+            gram_row[k] = dot_product(gradients[k], function_output.gradient);
+            gram[k].push_back(gram_row[k]);
+        }
+        gram_row.back() = squared_norm(function_output.gradient);
+        gram.push_back(gram_row);
+        gradients.push_back(function_output.gradient);
+        values.push_back(value_new);
+        alphas.push_back(0);
+
+        if (increase >= serious_step_fraction * predicted_increase) {
+            // Serious step: move the center.
+            for (Counter k = 0; k < (Counter)values.size(); ++k)
+                values[k] += dot_product(gradients[k], step);
+            center = multipliers;
+            value_center = function_output.objective_value;
+            if (increase >= 0.5 * predicted_increase)
+                u = (std::max)(u_min, u / 2);
+        } else {
+            // Null step.
+            u = (std::min)(u_max, u * 1.5);
+        }
+    }
+}
+
+/**
+ * Make the evaluations of the dual function of a model run a Lagrangian
+ * heuristic.
+ *
+ * To limit its cost, the heuristic is only run after the evaluations which
+ * improve the best value of the dual function. It is given the multipliers
+ * of the evaluation and the number of evaluations so far.
+ */
+void add_lagrangian_heuristic(
+        mathoptsolverscmake::MathOptModel& model,
+        LagrangianRelaxationOutput& output,
+        const std::function<void (const std::vector<double>&, Counter)>& heuristic)
+{
+    auto objective_function = model.objective_function;
+    auto value_best = std::make_shared<double>(-std::numeric_limits<double>::infinity());
+    auto number_of_evaluations = std::make_shared<Counter>(0);
+    model.objective_function = [
+        objective_function,
+        &output,
+        heuristic,
+        value_best,
+        number_of_evaluations](
+            const std::vector<double>& multipliers)
+    {
+        mathoptsolverscmake::BlackBoxFunctionOutput function_output
+            = objective_function(multipliers);
+        (*number_of_evaluations)++;
+        if (function_output.objective_value > *value_best) {
+            *value_best = function_output.objective_value;
+            heuristic(multipliers, *number_of_evaluations);
+            output.number_of_lagrangian_heuristic_calls++;
+        }
+        return function_output;
+    };
+}
+
+/**
+ * Ergodic average of the solutions of the Lagrangian subproblems.
+ *
+ * It is a convex combination of the solutions of all the evaluations of the
+ * dual function, in which the weight of the solution of the k-th evaluation
+ * is proportional to k, so that the late solutions, computed from
+ * multipliers closer to the optimal ones, weigh more. It approaches an
+ * optimal solution of the linear relaxation.
+ *
+ * The weighted sums are stored in a flat item-major array:
+ * 'weighted_sums_[item_id * m + agent_id]'. Adding a solution costs one
+ * operation per assignment.
+ */
+class ErgodicAverage
+{
+
+public:
+
+    ErgodicAverage(
+            ItemIdx number_of_items,
+            AgentIdx number_of_agents):
+        number_of_agents_(number_of_agents),
+        weighted_sums_(number_of_items * number_of_agents, 0) { }
+
+    /** Start the solution of a new evaluation of the dual function. */
+    void new_solution() { number_of_solutions_++; }
+
+    /** Add an assignment to the current solution. */
+    void add(
+            ItemIdx item_id,
+            AgentIdx agent_id)
+    {
+        weighted_sums_[item_id * number_of_agents_ + agent_id] += number_of_solutions_;
+    }
+
+    /** Get the average: 'x[item_id][agent_id]'. */
+    std::vector<std::vector<double>> x() const
+    {
+        ItemIdx number_of_items = weighted_sums_.size() / number_of_agents_;
+        std::vector<std::vector<double>> x(
+                number_of_items,
+                std::vector<double>(number_of_agents_, 0));
+        if (number_of_solutions_ == 0)
+            return x;
+        double total_weight = (double)number_of_solutions_ * (number_of_solutions_ + 1) / 2;
+        for (ItemIdx item_id = 0; item_id < number_of_items; ++item_id) {
+            for (AgentIdx agent_id = 0; agent_id < number_of_agents_; ++agent_id) {
+                x[item_id][agent_id]
+                    = weighted_sums_[item_id * number_of_agents_ + agent_id]
+                    / total_weight;
+            }
+        }
+        return x;
+    }
+
+private:
+
+    /** Number of agents. */
+    AgentIdx number_of_agents_;
+
+    /** Number of solutions added. */
+    Counter number_of_solutions_ = 0;
+
+    /** Weighted sums of the solutions. */
+    std::vector<double> weighted_sums_;
+
+};
+
+/**
+ * Make the evaluations of the dual function of a model add the solution of
+ * the subproblems to an ergodic average.
+ */
+void add_ergodic_average(
+        mathoptsolverscmake::MathOptModel& model,
+        ErgodicAverage& ergodic_average,
+        const std::function<void (ErgodicAverage&)>& add_solution)
+{
+    auto objective_function = model.objective_function;
+    model.objective_function = [
+        objective_function,
+        &ergodic_average,
+        add_solution](
+            const std::vector<double>& multipliers)
+    {
+        mathoptsolverscmake::BlackBoxFunctionOutput function_output
+            = objective_function(multipliers);
+        ergodic_average.new_solution();
+        add_solution(ergodic_average);
+        return function_output;
+    };
+}
+
+/**
+ * Fill the ergodic average of an output and round it into a solution.
+ */
+void retrieve_ergodic_average(
+        const Instance& instance,
+        const ErgodicAverage& ergodic_average,
+        LagrangianRelaxationOutput& output,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    output.x = ergodic_average.x();
+    Solution solution = round_fractional_solution(instance, output.x);
+    if (solution.feasible())
+        algorithm_formatter.update_solution(solution, "ergodic rounding");
+}
+
+/**
+ * Maximize the Lagrangian dual with the optimizer selected in the
+ * parameters.
+ */
+void solve_lagrangian_dual(
+        const mathoptsolverscmake::MathOptModel& model,
+        const LagrangianRelaxationParameters& parameters,
+        LagrangianRelaxationOutput& output,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    if (parameters.dual_optimizer == "subgradient") {
+        LagrangianDualSearch search(model, parameters, output, algorithm_formatter);
+        lagrangian_dual_subgradient(model, search);
+        return;
+    }
+    if (parameters.dual_optimizer == "bundle") {
+        LagrangianDualSearch search(model, parameters, output, algorithm_formatter);
+        lagrangian_dual_bundle(model, search);
+        return;
+    }
+    if (parameters.dual_optimizer != "solver") {
+        throw std::invalid_argument(
+                "Unknown dual optimizer \"" + parameters.dual_optimizer + "\".");
+    }
+
+    double bcnlp_bound = 0;
+#if KNITRO_FOUND
+    if (parameters.solver == mathoptsolverscmake::SolverName::Knitro) {
+        knitrocpp::Context knitro_context;
+        mathoptsolverscmake::solve(model, knitro_context);
+        bcnlp_bound = mathoptsolverscmake::get_solution_value(knitro_context);
+        output.multipliers = mathoptsolverscmake::get_solution(knitro_context);
+    }
+#endif
+#if DLIB_FOUND
+    if (parameters.solver == mathoptsolverscmake::SolverName::Dlib) {
+        mathoptsolverscmake::DlibOutput dlib_output = mathoptsolverscmake::solve_dlib(model);
+        bcnlp_bound = dlib_output.objective_value;
+        output.multipliers = dlib_output.solution;
+    }
+#endif
+#if CONICBUNDLE_FOUND
+    if (parameters.solver == mathoptsolverscmake::SolverName::ConicBundle) {
+        ConicBundle::CBSolver solver(&std::cout, 1);
+        // Set relative precision
+        solver.set_term_relprec(1e-8);
+        mathoptsolverscmake::solve(model, solver);
+        solver.print_termination_code(std::cout);
+        bcnlp_bound = mathoptsolverscmake::get_solution_value(model, solver);
+        output.multipliers = mathoptsolverscmake::get_solution(model, solver);
+    }
+#endif
+
+    algorithm_formatter.update_bound(std::ceil(bcnlp_bound - FFOT_TOL), "");
+}
+
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ///////////////////////// lagrangian_relaxation_assignment /////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+
+/**
+ * Lagrangian heuristic of the relaxation of the assignment constraints.
+ *
+ * An item selected by several knapsack subproblems is assigned to the
+ * cheapest of these agents; since this only removes items from the
+ * knapsack solutions, capacities are satisfied. The missing items are then
+ * assigned by MTHG-regret, with the costs as desirabilities, which also
+ * improves the solution with shift moves.
+ */
+void lagrangian_relaxation_assignment_heuristic(
+        const Instance& instance,
+        const KnapsackSubproblems& knapsack_subproblems,
+        const std::vector<std::vector<double>>& desirability,
+        const std::vector<std::vector<AgentIdx>>& agents,
+        Counter iteration,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    Solution solution(instance);
+    for (AgentIdx agent_id = 0;
+            agent_id < instance.number_of_agents();
+            ++agent_id) {
+        for (ItemIdx item_id: knapsack_subproblems.selected_items(agent_id)) {
+            AgentIdx agent_id_cur = solution.agent(item_id);
+            if (agent_id_cur == -1
+                    || instance.cost(item_id, agent_id)
+                    < instance.cost(item_id, agent_id_cur)) {
+                solution.set(item_id, agent_id);
+            }
+        }
+    }
+    mthg_regret(solution, desirability, agents);
+    if (solution.feasible()) {
+        std::stringstream ss;
+        ss << "heuristic iteration " << iteration;
+        algorithm_formatter.update_solution(solution, ss.str());
+    }
+}
+
+}
+
 const LagrangianRelaxationAssignmentOutput generalizedassignmentsolver::lagrangian_relaxation_assignment(
         const Instance& instance,
         std::vector<double>* initial_multipliers,
@@ -50,58 +669,98 @@ const LagrangianRelaxationAssignmentOutput generalizedassignmentsolver::lagrangi
         }
     }
 
+    // Knapsack subproblems.
+    KnapsackSubproblems knapsack_subproblems(instance);
+    for (AgentIdx agent_id = 0; agent_id < instance.number_of_agents(); ++agent_id) {
+        knapsack_subproblems.set_subproblem(
+                agent_id,
+                kp_capacities[agent_id],
+                [&instance, &fixed_alt, agent_id](ItemIdx item_id)
+                {
+                    return (fixed_alt != NULL
+                            && (*fixed_alt)[item_id][agent_id] >= 0);
+                });
+    }
+
+    // Knapsack subproblems are solved in parallel. Each thread accumulates
+    // its part of the gradient in its own buffer and the value of each
+    // knapsack subproblem is stored separately, so that the reduction
+    // doesn't depend on the assignment of the agents to the threads.
+    Counter number_of_threads = (std::max)((Counter)1, (std::min)(
+                parameters.number_of_threads,
+                (Counter)instance.number_of_agents()));
+    std::vector<std::vector<double>> threads_gradients(
+            number_of_threads,
+            std::vector<double>(instance.number_of_items(), 0));
+    std::vector<double> agents_values(instance.number_of_agents(), 0);
+
     model.objective_direction = mathoptsolverscmake::ObjectiveDirection::Maximize;
-    model.objective_function = [&instance, &fixed_alt, &kp_capacities](
+    model.objective_function = [
+        &instance,
+        &knapsack_subproblems,
+        number_of_threads,
+        &threads_gradients,
+        &agents_values](
             const std::vector<double>& multipliers)
     {
         mathoptsolverscmake::BlackBoxFunctionOutput output;
 
-        // Initialize bound and gradient;
+        // Solve the knapsack subproblems. Agents are distributed dynamically
+        // to balance the load between the threads.
+        std::atomic<AgentIdx> agent_id_next(0);
+        auto solve_knapsacks = [
+            &instance,
+            &knapsack_subproblems,
+            &threads_gradients,
+            &agents_values,
+            &multipliers,
+            &agent_id_next](
+                Counter thread_id)
+        {
+            std::vector<double>& gradient = threads_gradients[thread_id];
+            std::fill(gradient.begin(), gradient.end(), 0);
+            for (;;) {
+                AgentIdx agent_id = agent_id_next++;
+                if (agent_id >= instance.number_of_agents())
+                    break;
+                const std::vector<ItemIdx>& items = knapsack_subproblems.solve(
+                        agent_id,
+                        multipliers);
+                double value = 0;
+                for (ItemIdx item_id: items) {
+                    gradient[item_id]--;
+                    value += instance.cost(item_id, agent_id) - multipliers[item_id];
+                }
+                agents_values[agent_id] = value;
+            }
+        };
+        std::vector<std::thread> threads;
+        for (Counter thread_id = 1;
+                thread_id < number_of_threads;
+                ++thread_id) {
+            threads.push_back(std::thread(solve_knapsacks, thread_id));
+        }
+        solve_knapsacks(0);
+        for (std::thread& thread: threads)
+            thread.join();
+
+        // Reduce bound and gradient.
         output.objective_value = 0;
         for (ItemIdx item_id = 0; item_id < instance.number_of_items(); ++item_id)
             output.objective_value += multipliers[item_id];
-        output.gradient = std::vector<double>(instance.number_of_items(), 1);
-
         for (AgentIdx agent_id = 0;
                 agent_id < instance.number_of_agents();
                 ++agent_id) {
-            // Create knapsack instance
-            knapsacksolver::InstanceFromFloatProfitsBuilder kp_instancebuilder;
-            kp_instancebuilder.set_capacity(kp_capacities[agent_id]);
-            std::vector<ItemIdx> kp_to_gap;
-            for (ItemIdx item_id = 0; item_id < instance.number_of_items(); ++item_id) {
-                if ((fixed_alt != NULL
-                            && (*fixed_alt)[item_id][agent_id] >= 0)) {
-                    continue;
-                }
-                if (instance.weight(item_id, agent_id) > kp_capacities[agent_id])
-                    continue;
-                double profit = multipliers[item_id] - instance.cost(item_id, agent_id);
-                if (profit <= 0)
-                    continue;
-                kp_instancebuilder.add_item(profit, instance.weight(item_id, agent_id));
-                kp_to_gap.push_back(item_id);
-            }
-            knapsacksolver::Instance kp_instance = kp_instancebuilder.build();
-
-            // Solve knapsack instance
-            knapsacksolver::DynamicProgrammingPrimalDualParameters kp_parameters;
-            kp_parameters.verbosity_level = 0;
-            //auto kp_output = knapsacksolver::dynamic_programming_bellman_array_all(kp_instance, kp_parameters);
-            auto kp_output = knapsacksolver::dynamic_programming_primal_dual(
-                    kp_instance,
-                    kp_parameters);
-            //std::cout << "i " << i << " opt " << kp_output.solution.profit() << std::endl;
-
-            // Update bound and gradient
-            for (knapsacksolver::ItemId kp_item_id = 0;
-                    kp_item_id < kp_instance.number_of_items();
-                    ++kp_item_id) {
-                if (!kp_output.solution.contains(kp_item_id))
-                    continue;
-                ItemIdx item_id = kp_to_gap[kp_item_id];
-                output.gradient[item_id]--;
-                output.objective_value += instance.cost(item_id, agent_id) - multipliers[item_id];
+            output.objective_value += agents_values[agent_id];
+        }
+        output.gradient = std::vector<double>(instance.number_of_items(), 1);
+        for (Counter thread_id = 0;
+                thread_id < number_of_threads;
+                ++thread_id) {
+            for (ItemIdx item_id = 0;
+                    item_id < instance.number_of_items();
+                    ++item_id) {
+                output.gradient[item_id] += threads_gradients[thread_id][item_id];
             }
         }
 
@@ -122,37 +781,62 @@ const LagrangianRelaxationAssignmentOutput generalizedassignmentsolver::lagrangi
         model.variables_initial_values = std::vector<double>(model.number_of_variables(), 0);
     }
 
-    // Solve.
-    double bcnlp_bound = 0;
-#if KNITRO_FOUND
-    if (parameters.solver == mathoptsolverscmake::SolverName::Knitro) {
-        knitrocpp::Context knitro_context;
-        mathoptsolverscmake::solve(model, knitro_context);
-        bcnlp_bound = mathoptsolverscmake::get_solution_value(knitro_context);
-        output.multipliers = mathoptsolverscmake::get_solution(knitro_context);
-    }
-#endif
-#if DLIB_FOUND
-    if (parameters.solver == mathoptsolverscmake::SolverName::Dlib) {
-        mathoptsolverscmake::DlibOutput dlib_output = mathoptsolverscmake::solve_dlib(model);
-        bcnlp_bound = dlib_output.objective_value;
-        output.multipliers = dlib_output.solution;
-    }
-#endif
-#if CONICBUNDLE_FOUND
-    if (parameters.solver == mathoptsolverscmake::SolverName::ConicBundle) {
-        ConicBundle::CBSolver solver(&std::cout, 1);
-        // Set relative precision
-        solver.set_term_relprec(1e-8);
-        mathoptsolverscmake::solve(model, solver);
-        solver.print_termination_code(std::cout);
-        bcnlp_bound = mathoptsolverscmake::get_solution_value(model, solver);
-        output.multipliers = mathoptsolverscmake::get_solution(model, solver);
+    // Ergodic average.
+    ErgodicAverage ergodic_average(instance.number_of_items(), instance.number_of_agents());
+    add_ergodic_average(
+            model,
+            ergodic_average,
+            [&instance, &knapsack_subproblems](ErgodicAverage& ergodic_average)
+            {
+                for (AgentIdx agent_id = 0;
+                        agent_id < instance.number_of_agents();
+                        ++agent_id) {
+                    for (ItemIdx item_id: knapsack_subproblems.selected_items(agent_id))
+                        ergodic_average.add(item_id, agent_id);
+                }
+            });
+
+    // Lagrangian heuristic.
+    std::vector<std::vector<double>> desirability;
+    std::vector<std::vector<AgentIdx>> agents;
+    if (parameters.lagrangian_heuristic && fixed_alt == NULL) {
+        desirability.resize(
+                instance.number_of_items(),
+                std::vector<double>(instance.number_of_agents()));
+        for (ItemIdx item_id = 0; item_id < instance.number_of_items(); ++item_id)
+            for (AgentIdx agent_id = 0; agent_id < instance.number_of_agents(); ++agent_id)
+                desirability[item_id][agent_id] = instance.cost(item_id, agent_id);
+        agents = greedy_regret_init(instance, desirability);
+        add_lagrangian_heuristic(
+                model,
+                output,
+                [&instance, &knapsack_subproblems, &desirability, &agents, &algorithm_formatter](
+                    const std::vector<double>&,
+                    Counter iteration)
+                {
+                    lagrangian_relaxation_assignment_heuristic(
+                            instance,
+                            knapsack_subproblems,
+                            desirability,
+                            agents,
+                            iteration,
+                            algorithm_formatter);
+                });
     }
-#endif
+
+    // Solve.
+    solve_lagrangian_dual(model, parameters, output, algorithm_formatter);
 
     // Fill output.
-    algorithm_formatter.update_bound(std::ceil(bcnlp_bound - FFOT_TOL), "");
+    if (fixed_alt == NULL) {
+        retrieve_ergodic_average(instance, ergodic_average, output, algorithm_formatter);
+    } else {
+        output.x = ergodic_average.x();
+        for (ItemIdx item_id = 0; item_id < instance.number_of_items(); ++item_id)
+            for (AgentIdx agent_id = 0; agent_id < instance.number_of_agents(); ++agent_id)
+                if ((*fixed_alt)[item_id][agent_id] == 1)
+                    output.x[item_id][agent_id] = 1;
+    }
 
     algorithm_formatter.end();
     return output;
@@ -162,6 +846,278 @@ const LagrangianRelaxationAssignmentOutput generalizedassignmentsolver::lagrangi
 ////////////////////////// lagrangian_relaxation_knapsack //////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+
+/**
+ * Minimum reduced cost of an item in the Lagrangian relaxation of the
+ * knapsack constraints.
+ *
+ * The reduced cost of assigning the item to agent 'i' is
+ * 'costs[i] + multipliers[i] * weights[i]'. 'agent_id' is the first agent
+ * reaching the minimum and 'number_of_minima' the number of agents reaching
+ * it.
+ */
+struct MinimumReducedCost
+{
+    double reduced_cost = std::numeric_limits<double>::infinity();
+    AgentIdx agent_id = -1;
+    AgentIdx number_of_minima = 0;
+};
+
+/**
+ * Functions computing the reduced costs of an item.
+ *
+ * The implementations compute the reduced cost of an agent with the same
+ * operations, so that all of them, and both functions of an
+ * implementation, return exactly the same values.
+ */
+using MinimumReducedCostFunction = MinimumReducedCost (*)(
+        AgentIdx number_of_agents,
+        const double* costs,
+        const double* weights,
+        const double* multipliers);
+
+using ReducedCostsFunction = void (*)(
+        AgentIdx number_of_agents,
+        const double* costs,
+        const double* weights,
+        const double* multipliers,
+        double* reduced_costs);
+
+inline void update_minimum_reduced_cost(
+        MinimumReducedCost& minimum,
+        AgentIdx agent_id,
+        double reduced_cost)
+{
+    if (minimum.agent_id == -1 || reduced_cost < minimum.reduced_cost) {
+        minimum.reduced_cost = reduced_cost;
+        minimum.agent_id = agent_id;
+        minimum.number_of_minima = 1;
+    } else if (reduced_cost == minimum.reduced_cost) {
+        minimum.number_of_minima++;
+    }
+}
+
+MinimumReducedCost minimum_reduced_cost_scalar(
+        AgentIdx number_of_agents,
+        const double* costs,
+        const double* weights,
+        const double* multipliers)
+{
+    MinimumReducedCost minimum;
+    for (AgentIdx agent_id = 0;
+            agent_id < number_of_agents;
+            ++agent_id) {
+        update_minimum_reduced_cost(
+                minimum,
+                agent_id,
+                costs[agent_id] + multipliers[agent_id] * weights[agent_id]);
+    }
+    return minimum;
+}
+
+void reduced_costs_scalar(
+        AgentIdx number_of_agents,
+        const double* costs,
+        const double* weights,
+        const double* multipliers,
+        double* reduced_costs)
+{
+    for (AgentIdx agent_id = 0;
+            agent_id < number_of_agents;
+            ++agent_id) {
+        reduced_costs[agent_id] = costs[agent_id] + multipliers[agent_id] * weights[agent_id];
+    }
+}
+
+#ifdef GENERALIZEDASSIGNMENTSOLVER_X86_DISPATCH
+
+__attribute__((target("avx2")))
+MinimumReducedCost minimum_reduced_cost_avx2(
+        AgentIdx number_of_agents,
+        const double* costs,
+        const double* weights,
+        const double* multipliers)
+{
+    AgentIdx number_of_agents_vectorized = number_of_agents - number_of_agents % 4;
+    if (number_of_agents_vectorized == 0) {
+        return minimum_reduced_cost_scalar(
+                number_of_agents,
+                costs,
+                weights,
+                multipliers);
+    }
+
+    // Minimum.
+    __m256d minimums = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    for (AgentIdx agent_id = 0;
+            agent_id < number_of_agents_vectorized;
+            agent_id += 4) {
+        __m256d reduced_costs = _mm256_add_pd(
+                _mm256_loadu_pd(costs + agent_id),
+                _mm256_mul_pd(
+                    _mm256_loadu_pd(multipliers + agent_id),
+                    _mm256_loadu_pd(weights + agent_id)));
+        minimums = _mm256_min_pd(minimums, reduced_costs);
+    }
+    double buffer[4];
+    _mm256_storeu_pd(buffer, minimums);
+    double reduced_cost_minimum = (std::min)(
+            (std::min)(buffer[0], buffer[1]),
+            (std::min)(buffer[2], buffer[3]));
+
+    // First agent reaching the minimum and number of agents reaching it.
+    MinimumReducedCost minimum;
+    minimum.reduced_cost = reduced_cost_minimum;
+    __m256d minimums_broadcast = _mm256_set1_pd(reduced_cost_minimum);
+    for (AgentIdx agent_id = 0;
+            agent_id < number_of_agents_vectorized;
+            agent_id += 4) {
+        __m256d reduced_costs = _mm256_add_pd(
+                _mm256_loadu_pd(costs + agent_id),
+                _mm256_mul_pd(
+                    _mm256_loadu_pd(multipliers + agent_id),
+                    _mm256_loadu_pd(weights + agent_id)));
+        int mask = _mm256_movemask_pd(
+                _mm256_cmp_pd(reduced_costs, minimums_broadcast, _CMP_EQ_OQ));
+        if (mask == 0)
+            continue;
+        if (minimum.agent_id == -1)
+            minimum.agent_id = agent_id + __builtin_ctz(mask);
+        minimum.number_of_minima += __builtin_popcount(mask);
+    }
+    for (AgentIdx agent_id = number_of_agents_vectorized;
+            agent_id < number_of_agents;
+            ++agent_id) {
+        update_minimum_reduced_cost(
+                minimum,
+                agent_id,
+                costs[agent_id] + multipliers[agent_id] * weights[agent_id]);
+    }
+    return minimum;
+}
+
+__attribute__((target("avx2")))
+void reduced_costs_avx2(
+        AgentIdx number_of_agents,
+        const double* costs,
+        const double* weights,
+        const double* multipliers,
+        double* reduced_costs)
+{
+    AgentIdx agent_id = 0;
+    for (; agent_id + 4 <= number_of_agents; agent_id += 4) {
+        _mm256_storeu_pd(
+                reduced_costs + agent_id,
+                _mm256_add_pd(
+                    _mm256_loadu_pd(costs + agent_id),
+                    _mm256_mul_pd(
+                        _mm256_loadu_pd(multipliers + agent_id),
+                        _mm256_loadu_pd(weights + agent_id))));
+    }
+    reduced_costs_scalar(
+            number_of_agents - agent_id,
+            costs + agent_id,
+            weights + agent_id,
+            multipliers + agent_id,
+            reduced_costs + agent_id);
+}
+
+#endif
+
+/**
+ * Get the best implementations of 'minimum_reduced_cost' and
+ * 'reduced_costs' supported by the CPU.
+ *
+ * There is no AVX-512 implementation: with AVX-512 enabled, the compiler
+ * contracts the multiplication and the addition into a fused
+ * multiply-add, which changes the reduced costs, and therefore the ties,
+ * compared to the other implementations.
+ */
+std::pair<MinimumReducedCostFunction, ReducedCostsFunction> reduced_costs_functions()
+{
+#ifdef GENERALIZEDASSIGNMENTSOLVER_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return {&minimum_reduced_cost_avx2, &reduced_costs_avx2};
+#endif
+    return {&minimum_reduced_cost_scalar, &reduced_costs_scalar};
+}
+
+/**
+ * Lagrangian heuristic of the relaxation of the knapsack constraints.
+ *
+ * Items are assigned to their agent in the solution of the relaxation.
+ * Then, the items of each overloaded agent are unassigned, by increasing
+ * ratio between the regret of their reduced cost and their weight, until
+ * the agent fits. The unassigned items are finally assigned by
+ * MTHG-regret with the reduced costs as desirabilities, which also
+ * improves the solution with shift moves.
+ */
+void lagrangian_relaxation_knapsack_heuristic(
+        const Instance& instance,
+        const std::vector<double>& multipliers,
+        const std::vector<MinimumReducedCost>& items_minimums,
+        Counter iteration,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    ItemIdx n = instance.number_of_items();
+    AgentIdx m = instance.number_of_agents();
+    std::vector<std::vector<double>> desirability(n, std::vector<double>(m));
+    for (ItemIdx item_id = 0; item_id < n; ++item_id) {
+        for (AgentIdx agent_id = 0; agent_id < m; ++agent_id) {
+            desirability[item_id][agent_id] = instance.cost(item_id, agent_id)
+                + multipliers[agent_id] * instance.weight(item_id, agent_id);
+        }
+    }
+
+    Solution solution(instance);
+    std::vector<std::vector<ItemIdx>> agents_items(m);
+    for (ItemIdx item_id = 0; item_id < n; ++item_id) {
+        AgentIdx agent_id = items_minimums[item_id].agent_id;
+        solution.set(item_id, agent_id);
+        agents_items[agent_id].push_back(item_id);
+    }
+
+    // Fix the overloaded agents.
+    std::vector<std::pair<double, ItemIdx>> items_scores;
+    for (AgentIdx agent_id = 0; agent_id < m; ++agent_id) {
+        if (solution.overcapacity(agent_id) == 0)
+            continue;
+        items_scores.clear();
+        for (ItemIdx item_id: agents_items[agent_id]) {
+            double regret = std::numeric_limits<double>::infinity();
+            for (AgentIdx agent_id_2 = 0; agent_id_2 < m; ++agent_id_2) {
+                if (agent_id_2 == agent_id)
+                    continue;
+                regret = (std::min)(
+                        regret,
+                        desirability[item_id][agent_id_2] - desirability[item_id][agent_id]);
+            }
+            items_scores.push_back({
+                    regret / (std::max)((Weight)1, instance.weight(item_id, agent_id)),
+                    item_id});
+        }
+        std::sort(items_scores.begin(), items_scores.end());
+        for (const auto& item_score: items_scores) {
+            if (solution.overcapacity(agent_id) == 0)
+                break;
+            solution.set(item_score.second, -1);
+        }
+    }
+
+    auto agents = greedy_regret_init(instance, desirability);
+    mthg_regret(solution, desirability, agents);
+    if (solution.feasible()) {
+        std::stringstream ss;
+        ss << "heuristic iteration " << iteration;
+        algorithm_formatter.update_solution(solution, ss.str());
+    }
+}
+
+}
+
 const LagrangianRelaxationKnapsackOutput generalizedassignmentsolver::lagrangian_relaxation_knapsack(
         const Instance& instance,
         std::vector<double>* initial_multipliers,
@@ -175,44 +1131,144 @@ const LagrangianRelaxationKnapsackOutput generalizedassignmentsolver::lagrangian
 
     mathoptsolverscmake::MathOptModel model;
 
+    ItemIdx n = instance.number_of_items();
+    AgentIdx m = instance.number_of_agents();
+
+    // Item-major copies of the costs and weights:
+    // 'costs[item_id * m + agent_id]'.
+    std::vector<double> costs(n * m);
+    std::vector<double> weights(n * m);
+    for (ItemIdx item_id = 0; item_id < n; ++item_id) {
+        for (AgentIdx agent_id = 0; agent_id < m; ++agent_id) {
+            costs[item_id * m + agent_id] = instance.cost(item_id, agent_id);
+            weights[item_id * m + agent_id] = instance.weight(item_id, agent_id);
+        }
+    }
+
+    // Items are split into contiguous blocks, one per thread. Each thread
+    // accumulates the weights of the items with a unique minimum reduced
+    // cost in its own gradient buffer.
+    Counter number_of_threads = (std::max)((Counter)1, (std::min)(
+                parameters.number_of_threads,
+                (Counter)n));
+    std::vector<std::vector<double>> threads_gradients(
+            number_of_threads,
+            std::vector<double>(m, 0));
+    std::vector<uint8_t> threads_ties(number_of_threads, 0);
+    // Minimum reduced cost of each item. After an evaluation, 'agent_id'
+    // is the agent of the item in the solution of the relaxation.
+    std::vector<MinimumReducedCost> items_minimums(n);
+    std::vector<double> reduced_costs(m);
+    auto functions = reduced_costs_functions();
+    MinimumReducedCostFunction minimum_reduced_cost = functions.first;
+    ReducedCostsFunction compute_reduced_costs = functions.second;
+
     model.objective_direction = mathoptsolverscmake::ObjectiveDirection::Maximize;
-    model.objective_function = [&instance, &fixed_alt](
+    model.objective_function = [
+        &instance,
+        n,
+        m,
+        &costs,
+        &weights,
+        number_of_threads,
+        &threads_gradients,
+        &threads_ties,
+        &items_minimums,
+        &reduced_costs,
+        minimum_reduced_cost,
+        compute_reduced_costs](
             const std::vector<double>& multipliers)
     {
         mathoptsolverscmake::BlackBoxFunctionOutput output;
 
+        // Solve the trivial Generalized Upper Bound Problems.
+        auto solve_items = [
+            n,
+            m,
+            &costs,
+            &weights,
+            number_of_threads,
+            &threads_gradients,
+            &threads_ties,
+            &items_minimums,
+            &multipliers,
+            minimum_reduced_cost](
+                Counter thread_id)
+        {
+            std::vector<double>& gradient = threads_gradients[thread_id];
+            std::fill(gradient.begin(), gradient.end(), 0);
+            threads_ties[thread_id] = 0;
+            ItemIdx item_id_start = n * thread_id / number_of_threads;
+            ItemIdx item_id_end = n * (thread_id + 1) / number_of_threads;
+            for (ItemIdx item_id = item_id_start; item_id < item_id_end; ++item_id) {
+                MinimumReducedCost minimum = minimum_reduced_cost(
+                        m,
+                        costs.data() + item_id * m,
+                        weights.data() + item_id * m,
+                        multipliers.data());
+                items_minimums[item_id] = minimum;
+                if (minimum.number_of_minima == 1) {
+                    gradient[minimum.agent_id] += weights[item_id * m + minimum.agent_id];
+                } else {
+                    threads_ties[thread_id] = 1;
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (Counter thread_id = 1;
+                thread_id < number_of_threads;
+                ++thread_id) {
+            threads.push_back(std::thread(solve_items, thread_id));
+        }
+        solve_items(0);
+        for (std::thread& thread: threads)
+            thread.join();
+
         // Initialize bound and gradient
         output.objective_value = 0;
-        output.gradient = std::vector<double>(instance.number_of_agents(), 0);
-        for (AgentIdx agent_id = 0; agent_id < instance.number_of_agents(); ++agent_id) {
+        output.gradient = std::vector<double>(m, 0);
+        for (AgentIdx agent_id = 0; agent_id < m; ++agent_id) {
             output.objective_value -= multipliers[agent_id] * instance.capacity(agent_id);
             output.gradient[agent_id] = -instance.capacity(agent_id);
         }
 
-        for (ItemIdx item_id = 0; item_id < instance.number_of_items(); ++item_id) {
-            // Solve the trivial Generalized Upper Bound Problem
-            AgentIdx agent_id_best = -1;
-            double rc_best = -1;
-            for (AgentIdx agent_id = 0; agent_id < instance.number_of_agents(); ++agent_id) {
-                double rc = instance.cost(item_id, agent_id) + multipliers[agent_id] * instance.weight(item_id, agent_id);
-                if (agent_id_best == -1
-                        || rc_best > rc
-                        // If the minimum reduced cost of a job is reached for
-                        // several agents, schedule the job on the agent with the
-                        // most available remaining capacity.
-                        // Without this condition, the relaxation fails to get the
-                        // optimal bound (the one from the linear relaxation) for
-                        // some instances.
-                        || (rc_best == rc && output.gradient[agent_id] > output.gradient[agent_id_best])) {
-                    agent_id_best = agent_id;
-                    rc_best = rc;
+        // Update bound.
+        for (ItemIdx item_id = 0; item_id < n; ++item_id)
+            output.objective_value += items_minimums[item_id].reduced_cost;
+
+        // Update gradient.
+        bool ties = std::find(threads_ties.begin(), threads_ties.end(), 1) != threads_ties.end();
+        if (!ties) {
+            for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
+                for (AgentIdx agent_id = 0; agent_id < m; ++agent_id)
+                    output.gradient[agent_id] += threads_gradients[thread_id][agent_id];
+            return output;
+        }
+        for (ItemIdx item_id = 0; item_id < n; ++item_id) {
+            MinimumReducedCost& minimum = items_minimums[item_id];
+            AgentIdx agent_id_best = minimum.agent_id;
+            if (minimum.number_of_minima > 1) {
+                // If the minimum reduced cost of a job is reached for
+                // several agents, schedule the job on the agent with the
+                // most available remaining capacity.
+                // Without this condition, the relaxation fails to get the
+                // optimal bound (the one from the linear relaxation) for
+                // some instances.
+                compute_reduced_costs(
+                        m,
+                        costs.data() + item_id * m,
+                        weights.data() + item_id * m,
+                        multipliers.data(),
+                        reduced_costs.data());
+                for (AgentIdx agent_id = agent_id_best + 1; agent_id < m; ++agent_id) {
+                    if (reduced_costs[agent_id] == minimum.reduced_cost
+                            && output.gradient[agent_id] > output.gradient[agent_id_best]) {
+                        agent_id_best = agent_id;
+                    }
                 }
+                minimum.agent_id = agent_id_best;
             }
-
-            // Update bound and gradient
-            output.gradient[agent_id_best] += instance.weight(item_id, agent_id_best);
-            //x_(item_id) = agent_id_best;
-            output.objective_value += rc_best;
+            output.gradient[agent_id_best] += weights[item_id * m + agent_id_best];
         }
         return output;
     };
@@ -231,37 +1287,40 @@ const LagrangianRelaxationKnapsackOutput generalizedassignmentsolver::lagrangian
         model.variables_initial_values = std::vector<double>(model.number_of_variables(), 0);
     }
 
-    // Solve.
-    double bcnlp_bound = 0;
-#if KNITRO_FOUND
-    if (parameters.solver == mathoptsolverscmake::SolverName::Knitro) {
-        knitrocpp::Context knitro_context;
-        mathoptsolverscmake::solve(model, knitro_context);
-        bcnlp_bound = mathoptsolverscmake::get_solution_value(knitro_context);
-        output.multipliers = mathoptsolverscmake::get_solution(knitro_context);
-    }
-#endif
-#if DLIB_FOUND
-    if (parameters.solver == mathoptsolverscmake::SolverName::Dlib) {
-        mathoptsolverscmake::DlibOutput dlib_output = mathoptsolverscmake::solve_dlib(model);
-        bcnlp_bound = dlib_output.objective_value;
-        output.multipliers = dlib_output.solution;
-    }
-#endif
-#if CONICBUNDLE_FOUND
-    if (parameters.solver == mathoptsolverscmake::SolverName::ConicBundle) {
-        ConicBundle::CBSolver solver(&std::cout, 1);
-        // Set relative precision
-        solver.set_term_relprec(1e-8);
-        mathoptsolverscmake::solve(model, solver);
-        solver.print_termination_code(std::cout);
-        bcnlp_bound = mathoptsolverscmake::get_solution_value(model, solver);
-        output.multipliers = mathoptsolverscmake::get_solution(model, solver);
+    // Ergodic average.
+    ErgodicAverage ergodic_average(n, m);
+    add_ergodic_average(
+            model,
+            ergodic_average,
+            [n, &items_minimums](ErgodicAverage& ergodic_average)
+            {
+                for (ItemIdx item_id = 0; item_id < n; ++item_id)
+                    ergodic_average.add(item_id, items_minimums[item_id].agent_id);
+            });
+
+    // Lagrangian heuristic.
+    if (parameters.lagrangian_heuristic && fixed_alt == NULL) {
+        add_lagrangian_heuristic(
+                model,
+                output,
+                [&instance, &items_minimums, &algorithm_formatter](
+                    const std::vector<double>& multipliers,
+                    Counter iteration)
+                {
+                    lagrangian_relaxation_knapsack_heuristic(
+                            instance,
+                            multipliers,
+                            items_minimums,
+                            iteration,
+                            algorithm_formatter);
+                });
     }
-#endif
+
+    // Solve.
+    solve_lagrangian_dual(model, parameters, output, algorithm_formatter);
 
     // Fill output.
-    algorithm_formatter.update_bound(std::ceil(bcnlp_bound - FFOT_TOL), "");
+    retrieve_ergodic_average(instance, ergodic_average, output, algorithm_formatter);
 
     algorithm_formatter.end();
     return output;
@@ -0,0 +1,628 @@
+#include "generalizedassignmentsolver/algorithms/large_neighborhood_search.hpp"
+
+#include "generalizedassignmentsolver/algorithms/greedy.hpp"
+#include "generalizedassignmentsolver/algorithms/milp.hpp"
+#include "generalizedassignmentsolver/algorithm_formatter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace generalizedassignmentsolver;
+
+namespace
+{
+
+/**
+ * Global cost of a solution.
+ *
+ * Solutions are compared lexicographically on their overcapacity and their
+ * cost.
+ */
+using GlobalCost = std::pair<Weight, Cost>;
+
+GlobalCost global_cost(const Solution& solution)
+{
+    return {solution.overcapacity(), solution.cost()};
+}
+
+enum class DestroyOperator
+{
+    AgentSubset,
+    RelatedItems,
+    RandomItems,
+};
+
+enum class RepairOperator
+{
+    GreedyRegret,
+    Milp,
+};
+
+/** Data shared by the threads of the large neighborhood search. */
+struct LargeNeighborhoodSearchSharedData
+{
+    LargeNeighborhoodSearchSharedData(
+            const Instance& instance):
+        solution_best(instance) { }
+
+    /** Best solution found so far. */
+    Solution solution_best;
+
+    /** Desirability of the greedy-regret repair operator. */
+    std::vector<std::vector<double>> desirability;
+
+    /** For each item, agents sorted by desirability. */
+    std::vector<std::vector<AgentIdx>> agents;
+
+    /**
+     * Mutex protecting 'solution_best', the numbers of uses of the operators
+     * and the algorithm formatter.
+     */
+    std::mutex mutex;
+
+    /** Total number of iterations. */
+    std::atomic<Counter> number_of_iterations{0};
+
+    /** Number of uses of each destroy operator. */
+    std::vector<Counter> destroy_operators_number_of_uses;
+
+    /** Number of uses of each repair operator. */
+    std::vector<Counter> repair_operators_number_of_uses;
+};
+
+/** Statistics of an operator for the adaptive operator selection. */
+struct OperatorStatistics
+{
+    /** Weight of the operator in the roulette wheel. */
+    double weight = 1.0;
+
+    /** Sum of the scores of the operator in the current segment. */
+    double score = 0.0;
+
+    /** Number of uses of the operator in the current segment. */
+    Counter number_of_uses = 0;
+
+    /** Total number of uses of the operator. */
+    Counter total_number_of_uses = 0;
+};
+
+/** Data of a thread of the large neighborhood search. */
+struct LargeNeighborhoodSearchThreadData
+{
+    LargeNeighborhoodSearchThreadData(
+            const Instance& instance):
+        solution(instance),
+        agents_items(instance.number_of_agents()),
+        positions(instance.number_of_items(), -1),
+        removed(instance.number_of_items(), 0) { }
+
+    /** Current solution. */
+    Solution solution;
+
+    /** Items of each agent in the current solution. */
+    std::vector<std::vector<ItemIdx>> agents_items;
+
+    /** Position of each item in 'agents_items'. */
+    std::vector<ItemPos> positions;
+
+    /** Items removed by the destroy operator. */
+    std::vector<ItemIdx> removed_items;
+
+    /** Agents of the removed items before their removal. */
+    std::vector<AgentIdx> removed_items_agents;
+
+    /** For each item, '1' iff it has been removed. */
+    std::vector<uint8_t> removed;
+
+    /** Statistics of the destroy operators. */
+    std::vector<OperatorStatistics> destroy_operators;
+
+    /** Statistics of the repair operators. */
+    std::vector<OperatorStatistics> repair_operators;
+};
+
+void set_agents_items(
+        LargeNeighborhoodSearchThreadData& data)
+{
+    for (std::vector<ItemIdx>& items: data.agents_items)
+        items.clear();
+    for (ItemIdx item_id = 0;
+            item_id < data.solution.instance().number_of_items();
+            ++item_id) {
+        std::vector<ItemIdx>& items = data.agents_items[data.solution.agent(item_id)];
+        data.positions[item_id] = items.size();
+        items.push_back(item_id);
+    }
+}
+
+void move_agents_item(
+        LargeNeighborhoodSearchThreadData& data,
+        ItemIdx item_id,
+        AgentIdx agent_id_old,
+        AgentIdx agent_id_new)
+{
+    std::vector<ItemIdx>& items_old = data.agents_items[agent_id_old];
+    ItemPos pos = data.positions[item_id];
+    items_old[pos] = items_old.back();
+    data.positions[items_old[pos]] = pos;
+    items_old.pop_back();
+    data.positions[item_id] = data.agents_items[agent_id_new].size();
+    data.agents_items[agent_id_new].push_back(item_id);
+}
+
+void remove_item(
+        LargeNeighborhoodSearchThreadData& data,
+        ItemIdx item_id)
+{
+    data.removed[item_id] = 1;
+    data.removed_items.push_back(item_id);
+    data.removed_items_agents.push_back(data.solution.agent(item_id));
+    data.solution.set(item_id, -1);
+}
+
+/** Assign the items which are still unassigned, allowing overcapacity. */
+void complete_solution(
+        Solution& solution,
+        const std::vector<ItemIdx>& items)
+{
+    const Instance& instance = solution.instance();
+    for (ItemIdx item_id: items) {
+        if (solution.agent(item_id) != -1)
+            continue;
+        AgentIdx agent_id_best = -1;
+        GlobalCost c_best;
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            Weight remaining_capacity = (std::max)(
+                    (Weight)0,
+                    solution.remaining_capacity(agent_id));
+            GlobalCost c = {
+                (std::max)(
+                        (Weight)0,
+                        instance.weight(item_id, agent_id) - remaining_capacity),
+                instance.cost(item_id, agent_id)};
+            if (agent_id_best == -1 || c < c_best) {
+                agent_id_best = agent_id;
+                c_best = c;
+            }
+        }
+        solution.set(item_id, agent_id_best);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////// Destroy operators ///////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Remove items of two to four randomly selected agents.
+ *
+ * Items are removed from the selected agents in turn, so that the removed
+ * items can be exchanged between them.
+ */
+void destroy_agent_subset(
+        LargeNeighborhoodSearchThreadData& data,
+        ItemIdx number_of_removed_items,
+        std::mt19937_64& generator)
+{
+    const Instance& instance = data.solution.instance();
+    std::vector<AgentIdx> agents(instance.number_of_agents());
+    std::iota(agents.begin(), agents.end(), 0);
+    std::shuffle(agents.begin(), agents.end(), generator);
+    std::uniform_int_distribution<AgentIdx> d_number_of_agents(
+            (std::min)(instance.number_of_agents(), (AgentIdx)2),
+            (std::min)(instance.number_of_agents(), (AgentIdx)4));
+    agents.resize(d_number_of_agents(generator));
+
+    std::vector<std::vector<ItemIdx>> agents_items;
+    for (AgentIdx agent_id: agents) {
+        agents_items.push_back(data.agents_items[agent_id]);
+        std::shuffle(agents_items.back().begin(), agents_items.back().end(), generator);
+    }
+    for (ItemPos pos = 0;; ++pos) {
+        bool removed = false;
+        for (const std::vector<ItemIdx>& items: agents_items) {
+            if ((ItemIdx)data.removed_items.size() >= number_of_removed_items)
+                return;
+            if (pos >= (ItemPos)items.size())
+                continue;
+            remove_item(data, items[pos]);
+            removed = true;
+        }
+        if (!removed)
+            return;
+    }
+}
+
+/**
+ * Remove items which can be exchanged at a small cost.
+ *
+ * Starting from a random item, each new item is the most related item to a
+ * removed item among a small random sample. Two items assigned to different
+ * agents are all the more related that swapping their agents changes the
+ * cost less.
+ */
+void destroy_related_items(
+        LargeNeighborhoodSearchThreadData& data,
+        ItemIdx number_of_removed_items,
+        std::mt19937_64& generator)
+{
+    const Instance& instance = data.solution.instance();
+    const ItemIdx sample_size = 16;
+    std::uniform_int_distribution<ItemIdx> d_item(0, instance.number_of_items() - 1);
+    remove_item(data, d_item(generator));
+    while ((ItemIdx)data.removed_items.size() < number_of_removed_items) {
+        std::uniform_int_distribution<ItemPos> d_removed(0, data.removed_items.size() - 1);
+        ItemPos pos = d_removed(generator);
+        ItemIdx item_id_1 = data.removed_items[pos];
+        AgentIdx agent_id_1 = data.removed_items_agents[pos];
+
+        ItemIdx item_id_best = -1;
+        Cost relatedness_best = -1;
+        for (ItemIdx sample_pos = 0; sample_pos < sample_size; ++sample_pos) {
+            ItemIdx item_id_2 = d_item(generator);
+            if (data.removed[item_id_2])
+                continue;
+            AgentIdx agent_id_2 = data.solution.agent(item_id_2);
+            // Items of the same agent come after the others.
+            Cost relatedness = (agent_id_1 == agent_id_2)?
+                2 * instance.maximum_cost() + 1:
+                std::abs(
+                        instance.cost(item_id_1, agent_id_2)
+                        + instance.cost(item_id_2, agent_id_1)
+                        - instance.cost(item_id_1, agent_id_1)
+                        - instance.cost(item_id_2, agent_id_2));
+            if (item_id_best == -1 || relatedness < relatedness_best) {
+                item_id_best = item_id_2;
+                relatedness_best = relatedness;
+            }
+        }
+        if (item_id_best != -1)
+            remove_item(data, item_id_best);
+    }
+}
+
+/** Remove random items. */
+void destroy_random_items(
+        LargeNeighborhoodSearchThreadData& data,
+        ItemIdx number_of_removed_items,
+        std::mt19937_64& generator)
+{
+    const Instance& instance = data.solution.instance();
+    std::uniform_int_distribution<ItemIdx> d_item(0, instance.number_of_items() - 1);
+    while ((ItemIdx)data.removed_items.size() < number_of_removed_items) {
+        ItemIdx item_id = d_item(generator);
+        if (!data.removed[item_id])
+            remove_item(data, item_id);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////// Repair operators ///////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+void repair_greedy_regret(
+        const LargeNeighborhoodSearchSharedData& shared_data,
+        LargeNeighborhoodSearchThreadData& data)
+{
+    greedy_regret(
+            data.solution,
+            shared_data.desirability,
+            shared_data.agents,
+            {});
+}
+
+void repair_milp(
+        const LargeNeighborhoodSearchParameters& parameters,
+        LargeNeighborhoodSearchThreadData& data)
+{
+    MilpParameters milp_parameters;
+    milp_parameters.verbosity_level = 0;
+    milp_parameters.solver = parameters.solver;
+    milp_parameters.timer.set_time_limit((std::min)(
+                parameters.milp_repair_time_limit,
+                parameters.timer.remaining_time()));
+    data.solution = milp_repair(data.solution, milp_parameters);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+Counter select_operator(
+        const std::vector<OperatorStatistics>& operators,
+        std::mt19937_64& generator)
+{
+    std::vector<double> weights;
+    for (const OperatorStatistics& operator_statistics: operators)
+        weights.push_back(operator_statistics.weight);
+    std::discrete_distribution<Counter> d(weights.begin(), weights.end());
+    return d(generator);
+}
+
+void update_operators_weights(
+        const LargeNeighborhoodSearchParameters& parameters,
+        std::vector<OperatorStatistics>& operators)
+{
+    // Operators keep a minimum weight so that they can still be selected
+    // after a few bad segments.
+    const double minimum_weight = 0.1;
+    for (OperatorStatistics& operator_statistics: operators) {
+        if (operator_statistics.number_of_uses > 0) {
+            operator_statistics.weight = (std::max)(
+                    minimum_weight,
+                    (1 - parameters.reaction_factor) * operator_statistics.weight
+                    + parameters.reaction_factor * operator_statistics.score
+                    / operator_statistics.number_of_uses);
+        }
+        operator_statistics.score = 0;
+        operator_statistics.number_of_uses = 0;
+    }
+}
+
+void large_neighborhood_search_worker(
+        const Instance& instance,
+        const LargeNeighborhoodSearchParameters& parameters,
+        Counter thread_id,
+        LargeNeighborhoodSearchSharedData& shared_data,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    // Scores of an iteration for the adaptive operator selection.
+    const double score_new_best = 3;
+    const double score_improvement = 2;
+    const double score_accepted = 1;
+    // A thread restarts from the best solution found so far after this
+    // number of iterations without improvement.
+    const Counter maximum_number_of_iterations_without_improvement
+        = 10 * parameters.segment_length;
+
+    std::mt19937_64 generator(parameters.seed + thread_id);
+    LargeNeighborhoodSearchThreadData data(instance);
+    data.destroy_operators.resize(3);
+    data.repair_operators.resize((parameters.milp_repair)? 2: 1);
+    ItemIdx minimum_number_of_removed_items = (std::max)((ItemIdx)1, (std::min)(
+                parameters.minimum_number_of_removed_items,
+                instance.number_of_items()));
+    ItemIdx maximum_number_of_removed_items = (std::max)(
+            minimum_number_of_removed_items,
+            (std::min)(
+                parameters.maximum_number_of_removed_items,
+                instance.number_of_items()));
+    std::uniform_int_distribution<ItemIdx> d_number_of_removed_items(
+            minimum_number_of_removed_items,
+            maximum_number_of_removed_items);
+
+    {
+        std::lock_guard<std::mutex> lock(shared_data.mutex);
+        data.solution = shared_data.solution_best;
+    }
+    set_agents_items(data);
+    GlobalCost c_cur = global_cost(data.solution);
+    // Best global cost of the thread since the last restart.
+    GlobalCost c_best = c_cur;
+    Counter iteration_last_improvement = 0;
+
+    for (Counter iteration = 1;; ++iteration) {
+        if (parameters.timer.needs_to_end())
+            break;
+        Counter number_of_iterations = shared_data.number_of_iterations++;
+        if (parameters.maximum_number_of_iterations != -1
+                && number_of_iterations >= parameters.maximum_number_of_iterations) {
+            shared_data.number_of_iterations--;
+            break;
+        }
+
+        // Restart from the best solution found so far.
+        if (iteration - iteration_last_improvement
+                > maximum_number_of_iterations_without_improvement) {
+            {
+                std::lock_guard<std::mutex> lock(shared_data.mutex);
+                data.solution = shared_data.solution_best;
+            }
+            set_agents_items(data);
+            c_cur = global_cost(data.solution);
+            c_best = c_cur;
+            iteration_last_improvement = iteration;
+        }
+
+        // Destroy.
+        Counter destroy_operator_id = select_operator(data.destroy_operators, generator);
+        ItemIdx number_of_removed_items = d_number_of_removed_items(generator);
+        switch ((DestroyOperator)destroy_operator_id) {
+        case DestroyOperator::AgentSubset:
+            destroy_agent_subset(data, number_of_removed_items, generator);
+            break;
+        case DestroyOperator::RelatedItems:
+            destroy_related_items(data, number_of_removed_items, generator);
+            break;
+        case DestroyOperator::RandomItems:
+            destroy_random_items(data, number_of_removed_items, generator);
+            break;
+        }
+
+        // Repair.
+        Counter repair_operator_id = select_operator(data.repair_operators, generator);
+        switch ((RepairOperator)repair_operator_id) {
+        case RepairOperator::GreedyRegret:
+            repair_greedy_regret(shared_data, data);
+            break;
+        case RepairOperator::Milp:
+            repair_milp(parameters, data);
+            break;
+        }
+        complete_solution(data.solution, data.removed_items);
+
+        // Accept or reject the new solution.
+        GlobalCost c = global_cost(data.solution);
+        double score = 0;
+        if (!(c_cur < c)) {
+            score = score_accepted;
+            if (c < c_cur) {
+                score = score_improvement;
+                if (c < c_best) {
+                    score = score_new_best;
+                    c_best = c;
+                    iteration_last_improvement = iteration;
+                }
+            }
+            c_cur = c;
+            for (ItemPos pos = 0; pos < (ItemPos)data.removed_items.size(); ++pos) {
+                ItemIdx item_id = data.removed_items[pos];
+                AgentIdx agent_id_old = data.removed_items_agents[pos];
+                AgentIdx agent_id_new = data.solution.agent(item_id);
+                if (agent_id_new != agent_id_old)
+                    move_agents_item(data, item_id, agent_id_old, agent_id_new);
+            }
+        } else {
+            for (ItemPos pos = 0; pos < (ItemPos)data.removed_items.size(); ++pos) {
+                data.solution.set(
+                        data.removed_items[pos],
+                        data.removed_items_agents[pos]);
+            }
+        }
+        for (ItemIdx item_id: data.removed_items)
+            data.removed[item_id] = 0;
+        data.removed_items.clear();
+        data.removed_items_agents.clear();
+
+        // Update operator statistics.
+        for (OperatorStatistics* operator_statistics: {
+                &data.destroy_operators[destroy_operator_id],
+                &data.repair_operators[repair_operator_id]}) {
+            operator_statistics->score += score;
+            operator_statistics->number_of_uses++;
+            operator_statistics->total_number_of_uses++;
+        }
+        if (iteration % parameters.segment_length == 0) {
+            update_operators_weights(parameters, data.destroy_operators);
+            update_operators_weights(parameters, data.repair_operators);
+        }
+
+        // Update best solution.
+        if (score == score_new_best) {
+            std::lock_guard<std::mutex> lock(shared_data.mutex);
+            if (c < global_cost(shared_data.solution_best)) {
+                shared_data.solution_best = data.solution;
+                algorithm_formatter.update_solution(
+                        data.solution,
+                        "thread " + std::to_string(thread_id)
+                        + " it " + std::to_string(iteration));
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(shared_data.mutex);
+    for (Counter operator_id = 0;
+            operator_id < (Counter)data.destroy_operators.size();
+            ++operator_id) {
+        shared_data.destroy_operators_number_of_uses[operator_id]
+            += data.destroy_operators[operator_id].total_number_of_uses;
+    }
+    for (Counter operator_id = 0;
+            operator_id < (Counter)data.repair_operators.size();
+            ++operator_id) {
+        shared_data.repair_operators_number_of_uses[operator_id]
+            += data.repair_operators[operator_id].total_number_of_uses;
+    }
+}
+
+}
+
+const LargeNeighborhoodSearchOutput generalizedassignmentsolver::large_neighborhood_search(
+        const Instance& instance,
+        const LargeNeighborhoodSearchParameters& parameters)
+{
+    LargeNeighborhoodSearchOutput output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Large neighborhood search");
+    algorithm_formatter.print_header();
+
+    LargeNeighborhoodSearchSharedData shared_data(instance);
+    shared_data.destroy_operators_number_of_uses.resize(3, 0);
+    shared_data.repair_operators_number_of_uses.resize((parameters.milp_repair)? 2: 1, 0);
+    shared_data.desirability = std::vector<std::vector<double>>(
+            instance.number_of_items(),
+            std::vector<double>(instance.number_of_agents()));
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            shared_data.desirability[item_id][agent_id]
+                = instance.cost(item_id, agent_id);
+        }
+    }
+    shared_data.agents = greedy_regret_init(instance, shared_data.desirability);
+
+    // Initial solution.
+    // Without initial solution, run MTHG with the '-pij/wij' desirability.
+    // Missing items are then inserted with the greedy-regret repair.
+    Solution solution(instance);
+    if (parameters.initial_solution != nullptr
+            && parameters.initial_solution->number_of_items() > 0) {
+        solution = *parameters.initial_solution;
+    } else {
+        std::vector<std::vector<double>> desirability(
+                instance.number_of_items(),
+                std::vector<double>(instance.number_of_agents()));
+        for (ItemIdx item_id = 0;
+                item_id < instance.number_of_items();
+                ++item_id) {
+            for (AgentIdx agent_id = 0;
+                    agent_id < instance.number_of_agents();
+                    ++agent_id) {
+                desirability[item_id][agent_id]
+                    = -(double)instance.profit(item_id, agent_id)
+                    / instance.weight(item_id, agent_id);
+            }
+        }
+        mthg(solution, greedy_init(instance, desirability));
+    }
+    if (!solution.full()) {
+        std::vector<ItemIdx> unassigned_items;
+        for (ItemIdx item_id = 0;
+                item_id < instance.number_of_items();
+                ++item_id) {
+            if (solution.agent(item_id) == -1)
+                unassigned_items.push_back(item_id);
+        }
+        greedy_regret(solution, shared_data.desirability, shared_data.agents, {});
+        complete_solution(solution, unassigned_items);
+    }
+    shared_data.solution_best = solution;
+    algorithm_formatter.update_solution(solution, "initial solution");
+
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1;
+            thread_id < parameters.number_of_threads;
+            ++thread_id) {
+        threads.push_back(std::thread(
+                    large_neighborhood_search_worker,
+                    std::ref(instance),
+                    std::ref(parameters),
+                    thread_id,
+                    std::ref(shared_data),
+                    std::ref(algorithm_formatter)));
+    }
+    large_neighborhood_search_worker(
+            instance,
+            parameters,
+            0,
+            shared_data,
+            algorithm_formatter);
+    for (std::thread& thread: threads)
+        thread.join();
+
+    output.number_of_iterations = shared_data.number_of_iterations;
+    output.destroy_operators_number_of_uses = shared_data.destroy_operators_number_of_uses;
+    output.repair_operators_number_of_uses = shared_data.repair_operators_number_of_uses;
+    algorithm_formatter.end();
+    return output;
+}
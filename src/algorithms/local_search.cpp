@@ -8,11 +8,275 @@
 
 #include <random>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#define GENERALIZEDASSIGNMENTSOLVER_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
 using namespace generalizedassignmentsolver;
 using namespace localsearchsolver;
 
+namespace
+{
+
+/**
+ * Compute, for each agent, the difference of overweight of the agent when
+ * adding an item to it.
+ *
+ * 'agent_weights', 'capacities' and 'item_weights' are indexed by agent.
+ */
+using OverweightDifferencesFunction = void (*)(
+        AgentIdx number_of_agents,
+        const Weight* agent_weights,
+        const Weight* capacities,
+        const Weight* item_weights,
+        Weight* overweight_differences);
+
+void overweight_differences_scalar(
+        AgentIdx number_of_agents,
+        const Weight* agent_weights,
+        const Weight* capacities,
+        const Weight* item_weights,
+        Weight* overweight_differences)
+{
+    for (AgentIdx agent_id = 0;
+            agent_id < number_of_agents;
+            ++agent_id) {
+        Weight slack = capacities[agent_id] - agent_weights[agent_id];
+        overweight_differences[agent_id]
+            = (std::max)((Weight)0, item_weights[agent_id] - slack)
+            - (std::max)((Weight)0, -slack);
+    }
+}
+
+#ifdef GENERALIZEDASSIGNMENTSOLVER_X86_DISPATCH
+
+__attribute__((target("avx2")))
+void overweight_differences_avx2(
+        AgentIdx number_of_agents,
+        const Weight* agent_weights,
+        const Weight* capacities,
+        const Weight* item_weights,
+        Weight* overweight_differences)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    AgentIdx agent_id = 0;
+    for (; agent_id + 4 <= number_of_agents; agent_id += 4) {
+        __m256i weights = _mm256_loadu_si256((const __m256i*)(agent_weights + agent_id));
+        __m256i caps = _mm256_loadu_si256((const __m256i*)(capacities + agent_id));
+        __m256i item = _mm256_loadu_si256((const __m256i*)(item_weights + agent_id));
+        __m256i excess = _mm256_sub_epi64(weights, caps);
+        __m256i excess_new = _mm256_add_epi64(excess, item);
+        // AVX2 has no 64-bit max: max(0, x) = x & (x > 0).
+        __m256i overweight = _mm256_and_si256(
+                _mm256_cmpgt_epi64(excess, zero), excess);
+        __m256i overweight_new = _mm256_and_si256(
+                _mm256_cmpgt_epi64(excess_new, zero), excess_new);
+        _mm256_storeu_si256(
+                (__m256i*)(overweight_differences + agent_id),
+                _mm256_sub_epi64(overweight_new, overweight));
+    }
+    overweight_differences_scalar(
+            number_of_agents - agent_id,
+            agent_weights + agent_id,
+            capacities + agent_id,
+            item_weights + agent_id,
+            overweight_differences + agent_id);
+}
+
+__attribute__((target("avx512f")))
+void overweight_differences_avx512(
+        AgentIdx number_of_agents,
+        const Weight* agent_weights,
+        const Weight* capacities,
+        const Weight* item_weights,
+        Weight* overweight_differences)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    AgentIdx agent_id = 0;
+    for (; agent_id + 8 <= number_of_agents; agent_id += 8) {
+        __m512i weights = _mm512_loadu_si512(agent_weights + agent_id);
+        __m512i caps = _mm512_loadu_si512(capacities + agent_id);
+        __m512i item = _mm512_loadu_si512(item_weights + agent_id);
+        __m512i excess = _mm512_sub_epi64(weights, caps);
+        __m512i excess_new = _mm512_add_epi64(excess, item);
+        __m512i overweight = _mm512_maskz_mov_epi64(
+                _mm512_cmpgt_epi64_mask(excess, zero), excess);
+        __m512i overweight_new = _mm512_maskz_mov_epi64(
+                _mm512_cmpgt_epi64_mask(excess_new, zero), excess_new);
+        _mm512_storeu_si512(
+                overweight_differences + agent_id,
+                _mm512_sub_epi64(overweight_new, overweight));
+    }
+    overweight_differences_scalar(
+            number_of_agents - agent_id,
+            agent_weights + agent_id,
+            capacities + agent_id,
+            item_weights + agent_id,
+            overweight_differences + agent_id);
+}
+
+#endif
+
+/**
+ * Binary heap of elements '0, ..., n - 1' with a key, supporting key updates
+ * and removals of any element.
+ *
+ * Elements are sorted by key, then by id.
+ */
+template <typename Key>
+class IndexedHeap
+{
+
+public:
+
+    /** Constructor. */
+    IndexedHeap(Counter number_of_elements):
+        keys_(number_of_elements),
+        positions_(number_of_elements, -1)
+    {
+        heap_.reserve(number_of_elements);
+    }
+
+    /** Return 'true' iff the heap is empty. */
+    inline bool empty() const { return heap_.empty(); }
+
+    /** Return 'true' iff an element is in the heap. */
+    inline bool contains(Counter element_id) const { return positions_[element_id] != -1; }
+
+    /** Get the element with the smallest key. */
+    inline Counter top() const { return heap_.front(); }
+
+    /** Insert an element or update its key. */
+    inline void update(
+            Counter element_id,
+            const Key& key)
+    {
+        keys_[element_id] = key;
+        Counter pos = positions_[element_id];
+        if (pos == -1) {
+            pos = heap_.size();
+            heap_.push_back(element_id);
+            positions_[element_id] = pos;
+        }
+        pos = sift_up(pos);
+        sift_down(pos);
+    }
+
+    /** Remove all elements. */
+    inline void clear()
+    {
+        for (Counter element_id: heap_)
+            positions_[element_id] = -1;
+        heap_.clear();
+    }
+
+    /** Remove an element if it is in the heap. */
+    inline void erase(Counter element_id)
+    {
+        Counter pos = positions_[element_id];
+        if (pos == -1)
+            return;
+        Counter element_id_last = heap_.back();
+        heap_.pop_back();
+        positions_[element_id] = -1;
+        if (element_id_last == element_id)
+            return;
+        heap_[pos] = element_id_last;
+        positions_[element_id_last] = pos;
+        pos = sift_up(pos);
+        sift_down(pos);
+    }
+
+private:
+
+    inline bool less(
+            Counter element_id_1,
+            Counter element_id_2) const
+    {
+        if (keys_[element_id_1] != keys_[element_id_2])
+            return keys_[element_id_1] < keys_[element_id_2];
+        return element_id_1 < element_id_2;
+    }
+
+    inline void swap(
+            Counter pos_1,
+            Counter pos_2)
+    {
+        std::swap(heap_[pos_1], heap_[pos_2]);
+        positions_[heap_[pos_1]] = pos_1;
+        positions_[heap_[pos_2]] = pos_2;
+    }
+
+    inline Counter sift_up(Counter pos)
+    {
+        while (pos > 0) {
+            Counter pos_parent = (pos - 1) / 2;
+            if (!less(heap_[pos], heap_[pos_parent]))
+                break;
+            swap(pos, pos_parent);
+            pos = pos_parent;
+        }
+        return pos;
+    }
+
+    inline void sift_down(Counter pos)
+    {
+        for (;;) {
+            Counter pos_best = pos;
+            Counter pos_child = 2 * pos + 1;
+            if (pos_child < (Counter)heap_.size()
+                    && less(heap_[pos_child], heap_[pos_best])) {
+                pos_best = pos_child;
+            }
+            if (pos_child + 1 < (Counter)heap_.size()
+                    && less(heap_[pos_child + 1], heap_[pos_best])) {
+                pos_best = pos_child + 1;
+            }
+            if (pos_best == pos)
+                break;
+            swap(pos, pos_best);
+            pos = pos_best;
+        }
+    }
+
+    /** Keys of the elements. */
+    std::vector<Key> keys_;
+
+    /** Elements of the heap. */
+    std::vector<Counter> heap_;
+
+    /** Position of each element in the heap, '-1' if not in the heap. */
+    std::vector<Counter> positions_;
+
+};
+
+/**
+ * Get the best implementation of 'overweight_differences' supported by the
+ * CPU.
+ */
+OverweightDifferencesFunction overweight_differences_function()
+{
+#ifdef GENERALIZEDASSIGNMENTSOLVER_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return &overweight_differences_avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return &overweight_differences_avx2;
+#endif
+    return &overweight_differences_scalar;
+}
+
+}
+
 class LocalScheme
 {
 
@@ -25,6 +289,49 @@ public:
     struct Parameters
     {
         Counter number_of_perturbations = 10;
+
+        /** Explore the swap neighborhood when no shift move is improving. */
+        bool swap_neighborhood = true;
+
+        /**
+         * Maximum number of items moved by an ejection chain.
+         *
+         * The ejection chain neighborhood is explored when no shift or swap
+         * move is improving. Set to '0' to disable it.
+         */
+        ItemIdx ejection_chain_maximum_depth = 4;
+
+        /**
+         * Number of agents considered when moving an item in an ejection
+         * chain.
+         *
+         * These are the agents with the smallest reduced costs
+         * 'c(j, i) - min_i c(j, i)' for the item.
+         */
+        AgentIdx ejection_chain_candidate_list_size = 4;
+
+        /**
+         * Use adaptive penalties for capacity violations.
+         *
+         * If 'true', each local search first descends on the scalarized cost
+         * 'cost + sum_i penalty_i * overweight_i' and then, if the solution
+         * is infeasible, on the lexicographic cost.
+         */
+        bool adaptive_penalty = false;
+
+        /**
+         * Maximum number of shift moves of a variable-depth search chain.
+         *
+         * The variable-depth search is run on the feasible local optima of
+         * the descent. Set to '0' to disable it.
+         */
+        ItemIdx variable_depth_search_maximum_depth = 0;
+
+        /**
+         * Number of alternative moves tried at each of the first two levels
+         * of a variable-depth search chain.
+         */
+        Counter variable_depth_search_breadth = 3;
     };
 
     LocalScheme(
@@ -32,9 +339,61 @@ public:
             Parameters parameters):
         instance_(instance),
         parameters_(parameters),
-        agents_(instance.number_of_agents())
+        agents_(instance.number_of_agents()),
+        capacities_(instance.number_of_agents()),
+        weights_(instance.number_of_items() * instance.number_of_agents()),
+        overweight_differences_(overweight_differences_function())
     {
         std::iota(agents_.begin(), agents_.end(), 0);
+
+        // Store capacities and weights contiguously for the batched move
+        // evaluation.
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            capacities_[agent_id] = instance.capacity(agent_id);
+        }
+        for (ItemIdx item_id = 0;
+                item_id < instance.number_of_items();
+                ++item_id) {
+            for (AgentIdx agent_id = 0;
+                    agent_id < instance.number_of_agents();
+                    ++agent_id) {
+                weights_[item_id * instance.number_of_agents() + agent_id]
+                    = instance.weight(item_id, agent_id);
+            }
+        }
+
+        // Initialize penalties.
+        if (parameters_.adaptive_penalty) {
+            penalties_.resize(
+                    instance.number_of_agents(),
+                    1 + instance.maximum_cost() / (std::max)((Weight)1, instance.maximum_weight()));
+        }
+
+        // Compute the candidate lists of the ejection chain neighborhood.
+        if (parameters_.ejection_chain_maximum_depth > 0) {
+            AgentIdx candidate_list_size = (std::min)(
+                    parameters_.ejection_chain_candidate_list_size,
+                    instance.number_of_agents());
+            candidate_agents_.resize(instance.number_of_items());
+            for (ItemIdx item_id = 0;
+                    item_id < instance.number_of_items();
+                    ++item_id) {
+                std::vector<AgentIdx>& agents = candidate_agents_[item_id];
+                agents = agents_;
+                std::partial_sort(
+                        agents.begin(),
+                        agents.begin() + candidate_list_size,
+                        agents.end(),
+                        [&instance, item_id](AgentIdx agent_id_1, AgentIdx agent_id_2)
+                        {
+                            return instance.cost(item_id, agent_id_1)
+                                < instance.cost(item_id, agent_id_2);
+                        });
+                agents.resize(candidate_list_size);
+            }
+        }
     }
 
     /*
@@ -122,6 +481,29 @@ public:
         };
     }
 
+    /**
+     * Get the global cost of a solution given penalties for the overweight
+     * of each agent.
+     *
+     * If 'penalties' is empty, this is the lexicographic global cost.
+     * Otherwise, the global cost is '<0, cost + sum_i penalty_i * overweight_i>'.
+     */
+    inline GlobalCost global_cost(
+            const Solution& solution,
+            const std::vector<Cost>& penalties) const
+    {
+        if (penalties.empty())
+            return global_cost(solution);
+        Cost cost = solution.cost;
+        for (AgentIdx agent_id = 0;
+                agent_id < instance_.number_of_agents();
+                ++agent_id) {
+            cost += penalties[agent_id]
+                * agent_overweight(agent_id, solution.weights[agent_id]);
+        }
+        return {0, cost};
+    }
+
     /*
      * Local search.
      */
@@ -134,19 +516,322 @@ public:
         GlobalCost cost_difference = worst<GlobalCost>();
     };
 
-    struct Perturbation;
+    /**
+     * Best improving shift move of each item.
+     *
+     * Items with an improving shift move are stored in a heap keyed by the
+     * cost difference of their move. For each agent, the items whose best
+     * move targets it are stored, so that these moves can be invalidated
+     * when the agent changes.
+     */
+    struct ShiftMoves
+    {
+        ShiftMoves(
+                ItemIdx number_of_items,
+                AgentIdx number_of_agents):
+            best_moves(number_of_items),
+            heap(number_of_items),
+            agents_targeting_items(number_of_agents),
+            targeting_positions(number_of_items, -1) { }
+
+        /**
+         * For each item, its best improving shift move. 'agent_id == -1' if
+         * the item has no improving shift move.
+         */
+        std::vector<MoveShift> best_moves;
+
+        /** Items with an improving shift move. */
+        IndexedHeap<GlobalCost> heap;
+
+        /** For each agent, the items whose best move targets it. */
+        std::vector<std::vector<ItemIdx>> agents_targeting_items;
+
+        /** Position of each item in 'agents_targeting_items'. */
+        std::vector<ItemPos> targeting_positions;
+
+        /** Remove all moves. */
+        void clear()
+        {
+            for (std::vector<ItemIdx>& items: agents_targeting_items) {
+                for (ItemIdx item_id: items) {
+                    best_moves[item_id].agent_id = -1;
+                    targeting_positions[item_id] = -1;
+                }
+                items.clear();
+            }
+            heap.clear();
+        }
+    };
+
+    /**
+     * Move exchanging the agents of two items.
+     *
+     * 'item_id_1' is moved from 'agent_id_1' to 'agent_id_2' and 'item_id_2'
+     * from 'agent_id_2' to 'agent_id_1'.
+     */
+    struct MoveSwap
+    {
+        ItemIdx item_id_1 = -1;
+        ItemIdx item_id_2 = -1;
+        AgentIdx agent_id_1 = -1;
+        AgentIdx agent_id_2 = -1;
+        GlobalCost cost_difference = worst<GlobalCost>();
+    };
+
+    /**
+     * Ejection chain.
+     *
+     * The first item is moved to the agent of the second item, the second
+     * item is ejected and moved to the agent of the third item, and so on.
+     * The last item is moved to any agent.
+     *
+     * Moves are stored as '(item_id, agent_id_old, agent_id)' like the moves
+     * of a perturbation.
+     */
+    struct MoveEjectionChain
+    {
+        std::vector<std::tuple<ItemIdx, AgentIdx, AgentIdx>> moves;
+        GlobalCost cost_difference = worst<GlobalCost>();
+    };
+
+    /** Shift move of a variable-depth search chain. */
+    struct MoveVariableDepthSearch
+    {
+        ItemIdx item_id = -1;
+        AgentIdx agent_id = -1;
+        GlobalCost global_cost = worst<GlobalCost>();
+    };
+
+    /**
+     * Structures used by a call of 'local_search'.
+     *
+     * Workspaces are sized once from the instance and reused by the
+     * successive calls, so that the local search doesn't allocate memory
+     * once all workspaces have reached their final size.
+     */
+    struct Workspace
+    {
+        Workspace(const Instance& instance):
+            shift_changed_agents(instance.number_of_agents()),
+            shift_relaxed_agents(instance.number_of_agents()),
+            shift_moves(instance.number_of_items(), instance.number_of_agents()),
+            shift_updated_items(instance.number_of_items()),
+            overweight_differences(instance.number_of_agents()),
+            swap_changed_agents(instance.number_of_agents()),
+            swap_best_moves(instance.number_of_agents() * instance.number_of_agents()),
+            agents_items(instance.number_of_agents()),
+            moved(instance.number_of_items(), 0),
+            variable_depth_search_moves(3),
+            perturbation_agents(instance.number_of_agents()) { }
+
+        /**
+         * Agents which have changed since the last shift neighborhood
+         * exploration.
+         */
+        optimizationtools::IndexedSet shift_changed_agents;
+
+        /** Changed agents whose weight may have decreased. */
+        optimizationtools::IndexedSet shift_relaxed_agents;
+
+        /** Best improving shift moves. */
+        ShiftMoves shift_moves;
+
+        /**
+         * Items whose best move has been recomputed during the current
+         * exploration.
+         */
+        optimizationtools::IndexedSet shift_updated_items;
+
+        /** Buffer for the items whose best move targets a changed agent. */
+        std::vector<ItemIdx> shift_targeting_items;
+
+        /**
+         * Buffer for the overweight differences of adding an item to each
+         * agent.
+         */
+        std::vector<Weight> overweight_differences;
+
+        /**
+         * Agents which have changed since the last swap neighborhood
+         * exploration.
+         */
+        optimizationtools::IndexedSet swap_changed_agents;
+
+        /**
+         * For each pair of agents 'agent_id_1 < agent_id_2', the best
+         * improving swap move between their items, stored at index
+         * 'agent_id_1 * m + agent_id_2'. 'item_id_1 == -1' if there is none.
+         */
+        std::vector<MoveSwap> swap_best_moves;
+
+        /** For each agent, its items sorted by decreasing weight. */
+        std::vector<std::vector<ItemIdx>> agents_items;
+
+        /** Items moved by the ejection chain being built. */
+        std::vector<uint8_t> moved;
+
+        /** Ejection chain being built. */
+        std::vector<std::tuple<ItemIdx, AgentIdx, AgentIdx>> chain;
+
+        /** Best ejection chain. */
+        MoveEjectionChain chain_best;
+
+        /**
+         * Candidate moves of the variable-depth search at the first level, at
+         * the second level, and at the deeper levels.
+         */
+        std::vector<std::vector<MoveVariableDepthSearch>> variable_depth_search_moves;
+
+        /**
+         * Global costs of the solution after each move of the variable-depth
+         * search chain stored in 'chain'.
+         */
+        std::vector<GlobalCost> variable_depth_search_global_costs;
+
+        /** Penalties used by the current local search. */
+        std::vector<Cost> penalties;
+
+        /** Buffer for the agents shuffled when building perturbations. */
+        std::vector<AgentIdx> perturbation_agents;
+
+        /** Value of 'capacity()' when the workspace has been acquired. */
+        std::size_t acquired_capacity = 0;
+
+        /** Total capacity of the buffers which may grow. */
+        std::size_t capacity() const
+        {
+            std::size_t capacity = shift_targeting_items.capacity()
+                + chain.capacity()
+                + chain_best.moves.capacity()
+                + variable_depth_search_global_costs.capacity();
+            for (const std::vector<MoveVariableDepthSearch>& moves: variable_depth_search_moves)
+                capacity += moves.capacity();
+            for (const std::vector<ItemIdx>& items: shift_moves.agents_targeting_items)
+                capacity += items.capacity();
+            for (const std::vector<ItemIdx>& items: agents_items)
+                capacity += items.capacity();
+            return capacity;
+        }
+    };
+
+    /** Get the number of buffer allocations of the workspaces. */
+    Counter number_of_workspace_buffer_allocations() const { return number_of_workspace_buffer_allocations_; }
+
+    /**
+     * Perturbation.
+     *
+     * A perturbation is a set of moves (item, agent before, agent after).
+     * Since each move assigns its item to a given agent, the order in which
+     * the moves are applied doesn't matter. Moves are kept sorted by item so
+     * that two identical perturbations have the same representation.
+     */
+    struct Perturbation
+    {
+        /** Moves, sorted by item. */
+        std::vector<std::tuple<ItemIdx, AgentIdx, AgentIdx>> moves;
+
+        /** Global cost of the solution before the perturbation. */
+        GlobalCost global_cost;
+
+        /**
+         * Hash of the perturbation.
+         *
+         * It is the sum of the hashes of its moves, so that it can be updated
+         * incrementally and doesn't depend on the order of the moves. It is
+         * zero for a value-initialized perturbation.
+         */
+        std::size_t hash;
+    };
 
     inline void local_search(
             Solution& solution,
             std::mt19937_64&,
             const Perturbation& perturbation = Perturbation())
     {
-        // Strucutres for the shift neighborhood.
-        // Agents which have changed since the last shift neighborhood
-        // exploration.
-        optimizationtools::IndexedSet shift_changed_agents(instance_.number_of_agents());
-        // Vector containing the improving moves of the shift neighborhood.
-        std::vector<MoveShift> shift_improving_moves;
+        std::unique_ptr<Workspace> workspace_ptr = acquire_workspace();
+        Workspace& workspace = *workspace_ptr;
+
+        if (!parameters_.adaptive_penalty) {
+            descent(solution, perturbation, std::vector<Cost>(), workspace);
+        } else {
+            // The penalties have changed since the solution has been
+            // computed, so it is not locally optimal anymore.
+            descent(solution, Perturbation(), workspace.penalties, workspace);
+            update_penalties(solution);
+            if (solution.overweight > 0)
+                descent(solution, Perturbation(), std::vector<Cost>(), workspace);
+        }
+
+        if (parameters_.variable_depth_search_maximum_depth > 0) {
+            while (variable_depth_search(solution, workspace))
+                descent(solution, Perturbation(), std::vector<Cost>(), workspace);
+        }
+
+        release_workspace(std::move(workspace_ptr));
+    }
+
+    /*
+     * Iterated local search
+     */
+
+    /** Add a move to a perturbation. */
+    inline void add_move(
+            Perturbation& perturbation,
+            ItemIdx item_id,
+            AgentIdx agent_id_old,
+            AgentIdx agent_id_new) const
+    {
+        auto move = std::make_tuple(item_id, agent_id_old, agent_id_new);
+        perturbation.moves.insert(
+                std::upper_bound(
+                    perturbation.moves.begin(),
+                    perturbation.moves.end(),
+                    move),
+                move);
+        std::size_t hash = 0;
+        optimizationtools::hash_combine(hash, std::hash<ItemIdx>()(item_id));
+        optimizationtools::hash_combine(hash, std::hash<AgentIdx>()(agent_id_old));
+        optimizationtools::hash_combine(hash, std::hash<AgentIdx>()(agent_id_new));
+        perturbation.hash += hash;
+    }
+
+    /**
+     * Apply improving moves until reaching a local optimum for the global
+     * cost defined by 'penalties'.
+     */
+    inline void descent(
+            Solution& solution,
+            const Perturbation& perturbation,
+            const std::vector<Cost>& penalties,
+            Workspace& workspace) const
+    {
+        // Structures for the shift neighborhood.
+        optimizationtools::IndexedSet& shift_changed_agents = workspace.shift_changed_agents;
+        optimizationtools::IndexedSet& shift_relaxed_agents = workspace.shift_relaxed_agents;
+        // The cost difference of a shift move only depends on the weights of
+        // its two agents. Therefore, when some agents change, the best move
+        // of an item which doesn't belong to a changed agent and whose best
+        // move doesn't target a changed agent can only be replaced by a move
+        // toward a changed agent whose weight has decreased.
+        ShiftMoves& shift_moves = workspace.shift_moves;
+        optimizationtools::IndexedSet& shift_updated_items = workspace.shift_updated_items;
+        std::vector<ItemIdx>& shift_targeting_items = workspace.shift_targeting_items;
+        std::vector<Weight>& overweight_differences = workspace.overweight_differences;
+
+        // Structures for the swap and ejection chain neighborhoods.
+        // They are only initialized at the first exploration of these
+        // neighborhoods since most calls end before it.
+        // As for shift moves, the best move of a pair of agents only needs to
+        // be updated when one of the two agents changes.
+        optimizationtools::IndexedSet& swap_changed_agents = workspace.swap_changed_agents;
+        std::vector<MoveSwap>& swap_best_moves = workspace.swap_best_moves;
+        std::vector<std::vector<ItemIdx>>& agents_items = workspace.agents_items;
+        bool agents_items_initialized = false;
+
+        shift_changed_agents.clear();
+        shift_relaxed_agents.clear();
+        shift_moves.clear();
+        swap_changed_agents.clear();
 
         // Initialize move structures.
         // If we call the local_search on a solution which has not been
@@ -159,6 +844,8 @@ public:
                     agent_id < instance_.number_of_agents();
                     ++agent_id) {
                 shift_changed_agents.add(agent_id);
+                shift_relaxed_agents.add(agent_id);
+                swap_changed_agents.add(agent_id);
             }
         } else {
             for (auto t: perturbation.moves) {
@@ -166,133 +853,258 @@ public:
                 AgentIdx agent_id = std::get<2>(t);
                 shift_changed_agents.add(agent_id);
                 shift_changed_agents.add(agent_id_old);
+                shift_relaxed_agents.add(agent_id);
+                shift_relaxed_agents.add(agent_id_old);
+                swap_changed_agents.add(agent_id);
+                swap_changed_agents.add(agent_id_old);
             }
         }
 
         Counter it = 0;
         (void)it;
         for (;; ++it) {
-            //std::cout << "it " << it << " cost " << to_string(global_cost(solution)) << std::endl;
+            //std::cout << "it " << it << " cost " << to_string(global_cost(solution, penalties)) << std::endl;
 
             // Shift neighborhood exploration.
 
-            // Remove obsolete moves.
-            for (auto it = shift_improving_moves.begin();
-                    it != shift_improving_moves.end();) {
-                if (shift_changed_agents.contains(it->agent_id_old)
-                        || shift_changed_agents.contains(it->agent_id)) {
-                    *it = *std::prev(shift_improving_moves.end());
-                    shift_improving_moves.pop_back();
-                } else {
-                    ++it;
+            // Update best moves.
+            // The moves of the items whose best move targets a changed agent
+            // and of the items belonging to a changed agent are recomputed
+            // toward all agents.
+            // For the other items, we only evaluate the shift moves toward
+            // the changed agents whose weight has decreased.
+            shift_updated_items.clear();
+            for (AgentIdx agent_id: shift_changed_agents) {
+                // The recomputed moves may target the agent again, so we
+                // iterate on a copy of its back-pointers.
+                shift_targeting_items = shift_moves.agents_targeting_items[agent_id];
+                for (ItemIdx item_id: shift_targeting_items) {
+                    if (shift_updated_items.contains(item_id))
+                        continue;
+                    compute_best_shift_move(
+                            solution,
+                            item_id,
+                            penalties,
+                            overweight_differences,
+                            shift_moves);
+                    shift_updated_items.add(item_id);
                 }
             }
-
-            // Evaluate new moves.
-            // For each item belonging to a changed agent, we add shift moves
-            // toward all agents.
-            // For each item belonging to an unchanged agent, we add shift
-            // moves toward all changed agents.
-            GlobalCost c_cur = global_cost(solution);
             for (ItemIdx item_id = 0;
                     item_id < instance_.number_of_items();
                     ++item_id) {
-                AgentIdx agent_id_old = solution.agents[item_id];
-                remove(solution, item_id);
-                if (shift_changed_agents.contains(agent_id_old)) {
-                    for (AgentIdx agent_id = 0; agent_id < instance_.number_of_agents(); ++agent_id) {
-                        if (agent_id == agent_id_old)
-                            continue;
-                        GlobalCost c = cost_add(solution, item_id, agent_id);
-                        if (c >= c_cur)
-                            continue;
-                        MoveShift move;
-                        move.item_id = item_id;
-                        move.agent_id_old = agent_id_old;
-                        move.agent_id = agent_id;
-                        move.cost_difference = c - c_cur;
-                        shift_improving_moves.push_back(move);
-                    }
-                } else {
-                    for (AgentIdx agent_id: shift_changed_agents) {
-                        if (agent_id == agent_id_old)
-                            continue;
-                        GlobalCost c = cost_add(solution, item_id, agent_id);
-                        if (c >= c_cur)
-                            continue;
-                        MoveShift move;
-                        move.item_id = item_id;
-                        move.agent_id_old = agent_id_old;
-                        move.agent_id = agent_id;
-                        move.cost_difference = c - c_cur;
-                        shift_improving_moves.push_back(move);
-                    }
+                if (shift_updated_items.contains(item_id))
+                    continue;
+                if (shift_changed_agents.contains(solution.agents[item_id])) {
+                    compute_best_shift_move(
+                            solution,
+                            item_id,
+                            penalties,
+                            overweight_differences,
+                            shift_moves);
+                } else if (!shift_relaxed_agents.empty()) {
+                    GlobalCost c_remove = cost_remove(solution, item_id, penalties);
+                    MoveShift move = shift_moves.best_moves[item_id];
+                    for (AgentIdx agent_id: shift_relaxed_agents)
+                        update_best_shift_move(solution, item_id, c_remove, agent_id, penalties, move);
+                    if (move.agent_id != shift_moves.best_moves[item_id].agent_id)
+                        set_best_shift_move(shift_moves, item_id, move);
                 }
-                add(solution, item_id, agent_id_old);
             }
             shift_changed_agents.clear();
+            shift_relaxed_agents.clear();
+
+            // If there is an improving shift move, apply it.
+            if (!shift_moves.heap.empty()) {
+                GlobalCost c_cur = global_cost(solution, penalties);
+                MoveShift move = shift_moves.best_moves[shift_moves.heap.top()];
+                remove(solution, move.item_id);
+                add(solution, move.item_id, move.agent_id);
+                check_cost(solution, penalties, c_cur, move.cost_difference);
+
+                // Update move structures.
+                if (agents_items_initialized) {
+                    remove_agent_item(agents_items, move.agent_id_old, move.item_id);
+                    add_agent_item(agents_items, move.agent_id, move.item_id);
+                }
+                shift_changed_agents.add(move.agent_id_old);
+                shift_changed_agents.add(move.agent_id);
+                shift_relaxed_agents.add(move.agent_id_old);
+                swap_changed_agents.add(move.agent_id_old);
+                swap_changed_agents.add(move.agent_id);
+                continue;
+            }
 
-            // If there is no improving move, then stop here.
-            if (shift_improving_moves.empty())
+            // Swap and ejection chain neighborhoods exploration.
+            if (!parameters_.swap_neighborhood
+                    && parameters_.ejection_chain_maximum_depth == 0) {
                 break;
+            }
 
-            // Otherwise, look for a pareto improving move.
-            //std::shuffle(shift_improving_moves.begin(), shift_improving_moves.end(), generator);
-            auto it_best = shift_improving_moves.begin();
-            for (auto it = shift_improving_moves.begin() + 1;
-                    it != shift_improving_moves.end(); ++it) {
-                if (it->cost_difference >= it_best->cost_difference
-                        || !dominates(it->cost_difference, it_best->cost_difference))
-                    continue;
-                it_best = it;
+            if (!agents_items_initialized) {
+                agents_items_initialized = true;
+                for (AgentIdx agent_id = 0;
+                        agent_id < instance_.number_of_agents();
+                        ++agent_id) {
+                    agents_items[agent_id].clear();
+                }
+                for (ItemIdx item_id = 0;
+                        item_id < instance_.number_of_items();
+                        ++item_id) {
+                    agents_items[solution.agents[item_id]].push_back(item_id);
+                }
+                for (AgentIdx agent_id = 0;
+                        agent_id < instance_.number_of_agents();
+                        ++agent_id) {
+                    std::sort(
+                            agents_items[agent_id].begin(),
+                            agents_items[agent_id].end(),
+                            [this, agent_id](ItemIdx item_id_1, ItemIdx item_id_2)
+                            {
+                                return instance_.weight(item_id_1, agent_id)
+                                    > instance_.weight(item_id_2, agent_id);
+                            });
+                }
+                for (MoveSwap& move: swap_best_moves)
+                    move.item_id_1 = -1;
             }
 
-            // Apply move.
-            remove(solution, it_best->item_id);
-            add(solution, it_best->item_id, it_best->agent_id);
-            if (global_cost(solution) != c_cur + it_best->cost_difference) {
-                throw std::logic_error("Costs do not match:\n"
-                        "* Current cost: " + to_string(c_cur) + "\n"
-                        + "* Move cost difference: " + to_string(it_best->cost_difference) + "\n"
-                        + "* Expected new cost: " + to_string(c_cur + it_best->cost_difference) + "\n"
-                        + "* Actual new cost: " + to_string(global_cost(solution)) + "\n");
+            // Update best moves of the pairs of agents containing a changed
+            // agent and look for the best improving move.
+            const MoveSwap* swap_move_best = nullptr;
+            if (parameters_.swap_neighborhood) {
+                for (AgentIdx agent_id_1 = 0;
+                        agent_id_1 < instance_.number_of_agents();
+                        ++agent_id_1) {
+                    for (AgentIdx agent_id_2 = agent_id_1 + 1;
+                            agent_id_2 < instance_.number_of_agents();
+                            ++agent_id_2) {
+                        MoveSwap& move = swap_best_moves[
+                            agent_id_1 * instance_.number_of_agents() + agent_id_2];
+                        if (swap_changed_agents.contains(agent_id_1)
+                                || swap_changed_agents.contains(agent_id_2)) {
+                            compute_best_swap_move(
+                                    solution,
+                                    agents_items,
+                                    penalties,
+                                    agent_id_1,
+                                    agent_id_2,
+                                    move);
+                        }
+                        if (move.item_id_1 != -1
+                                && (swap_move_best == nullptr
+                                    || move.cost_difference < swap_move_best->cost_difference)) {
+                            swap_move_best = &move;
+                        }
+                    }
+                }
+            }
+            swap_changed_agents.clear();
+
+            // If there is no improving swap move, explore the ejection chain
+            // neighborhood.
+            if (swap_move_best == nullptr) {
+                if (parameters_.ejection_chain_maximum_depth == 0)
+                    break;
+
+                MoveEjectionChain& chain_best = workspace.chain_best;
+                chain_best.moves.clear();
+                for (ItemIdx item_id = 0;
+                        item_id < instance_.number_of_items();
+                        ++item_id) {
+                    update_best_ejection_chain(
+                            solution,
+                            agents_items,
+                            penalties,
+                            item_id,
+                            workspace.moved,
+                            workspace.chain,
+                            chain_best);
+                }
+
+                // If there is no improving move, then stop here.
+                if (chain_best.moves.empty())
+                    break;
+
+                // Apply move.
+                GlobalCost c_cur = global_cost(solution, penalties);
+                for (auto t: chain_best.moves)
+                    remove(solution, std::get<0>(t));
+                for (auto t: chain_best.moves)
+                    add(solution, std::get<0>(t), std::get<2>(t));
+                check_cost(solution, penalties, c_cur, chain_best.cost_difference);
+
+                // Update move structures.
+                for (auto t: chain_best.moves) {
+                    ItemIdx item_id = std::get<0>(t);
+                    AgentIdx agent_id_old = std::get<1>(t);
+                    AgentIdx agent_id = std::get<2>(t);
+                    remove_agent_item(agents_items, agent_id_old, item_id);
+                    add_agent_item(agents_items, agent_id, item_id);
+                    shift_changed_agents.add(agent_id_old);
+                    shift_changed_agents.add(agent_id);
+                    shift_relaxed_agents.add(agent_id_old);
+                    swap_changed_agents.add(agent_id_old);
+                    swap_changed_agents.add(agent_id);
+                }
+                continue;
             }
 
+            // Apply move.
+            GlobalCost c_cur = global_cost(solution, penalties);
+            MoveSwap move = *swap_move_best;
+            remove(solution, move.item_id_1);
+            remove(solution, move.item_id_2);
+            add(solution, move.item_id_1, move.agent_id_2);
+            add(solution, move.item_id_2, move.agent_id_1);
+            check_cost(solution, penalties, c_cur, move.cost_difference);
+
             // Update move structures.
-            shift_changed_agents.add(it_best->agent_id_old);
-            shift_changed_agents.add(it_best->agent_id);
+            remove_agent_item(agents_items, move.agent_id_1, move.item_id_1);
+            remove_agent_item(agents_items, move.agent_id_2, move.item_id_2);
+            add_agent_item(agents_items, move.agent_id_2, move.item_id_1);
+            add_agent_item(agents_items, move.agent_id_1, move.item_id_2);
+            shift_changed_agents.add(move.agent_id_1);
+            shift_changed_agents.add(move.agent_id_2);
+            if (instance_.weight(move.item_id_2, move.agent_id_1)
+                    < instance_.weight(move.item_id_1, move.agent_id_1)) {
+                shift_relaxed_agents.add(move.agent_id_1);
+            }
+            if (instance_.weight(move.item_id_1, move.agent_id_2)
+                    < instance_.weight(move.item_id_2, move.agent_id_2)) {
+                shift_relaxed_agents.add(move.agent_id_2);
+            }
+            swap_changed_agents.add(move.agent_id_1);
+            swap_changed_agents.add(move.agent_id_2);
         }
     }
 
-    /*
-     * Iterated local search
-     */
-
-    struct Perturbation
-    {
-        std::vector<std::tuple<ItemIdx, AgentIdx, AgentIdx>> moves;
-        GlobalCost global_cost;
-    };
-
     inline std::vector<Perturbation> perturbations(
             Solution& solution,
             std::mt19937_64& generator)
     {
+        std::unique_ptr<Workspace> workspace_ptr = acquire_workspace();
         std::vector<Perturbation> perturbations;
+        // Workspace copy, since perturbations may be computed concurrently.
+        std::vector<AgentIdx>& agents = workspace_ptr->perturbation_agents;
+        agents.assign(agents_.begin(), agents_.end());
+        // Duplicate perturbations are drawn again, within a limit on the
+        // total number of draws.
         for (Counter perturbation_id = 0;
-                perturbation_id < parameters_.number_of_perturbations;
+                perturbation_id < 2 * parameters_.number_of_perturbations
+                && (Counter)perturbations.size() < parameters_.number_of_perturbations;
                 ++perturbation_id) {
             std::vector<ItemIdx> items = optimizationtools::bob_floyd<ItemIdx>(
                     (ItemIdx)8, instance_.number_of_items(), generator);
             std::shuffle(items.begin(), items.end(), generator);
-            Perturbation perturbation;
+            Perturbation perturbation{};
             for (ItemIdx item_id: items) {
                 AgentIdx agent_id_old = solution.agents[item_id];
                 AgentIdx agent_id_best = -1;
                 GlobalCost c_best = worst<GlobalCost>();
                 remove(solution, item_id);
-                std::shuffle(agents_.begin(), agents_.end(), generator);
-                for (AgentIdx agent_id: agents_) {
+                std::shuffle(agents.begin(), agents.end(), generator);
+                for (AgentIdx agent_id: agents) {
                     if (agent_id == agent_id_old)
                         continue;
                     GlobalCost c = cost_add(solution, item_id, agent_id);
@@ -302,11 +1114,23 @@ public:
                     }
                 }
                 add(solution, item_id, agent_id_old);
-                perturbation.moves.push_back({item_id, agent_id_old, agent_id_best});
+                add_move(perturbation, item_id, agent_id_old, agent_id_best);
             }
             perturbation.global_cost = global_cost(solution);
+            if (std::find_if(
+                        perturbations.begin(),
+                        perturbations.end(),
+                        [&perturbation](const Perturbation& p)
+                        {
+                            return p.hash == perturbation.hash
+                                && p.moves == perturbation.moves;
+                        }) != perturbations.end()) {
+                number_of_duplicate_perturbations_++;
+                continue;
+            }
             perturbations.push_back(perturbation);
         }
+        release_workspace(std::move(workspace_ptr));
         return perturbations;
     }
 
@@ -372,13 +1196,34 @@ public:
 
     struct PerturbationHasher
     {
-        inline bool hashable(const Perturbation&) const { return false; }
-        inline bool operator()(const Perturbation&, const Perturbation&) const { return false; }
-        inline std::size_t operator()(const Perturbation&) const { return 0; }
+        inline bool hashable(const Perturbation&) const { return true; }
+
+        inline bool operator()(
+                const Perturbation& perturbation_1,
+                const Perturbation& perturbation_2) const
+        {
+            return perturbation_1.hash == perturbation_2.hash
+                && perturbation_1.moves == perturbation_2.moves;
+        }
+
+        inline std::size_t operator()(
+                const Perturbation& perturbation) const
+        {
+            return perturbation.hash;
+        }
     };
 
     inline PerturbationHasher perturbation_hasher() const { return PerturbationHasher(); }
 
+    /** Get the number of duplicate perturbations drawn again. */
+    inline Counter number_of_duplicate_perturbations() const { return number_of_duplicate_perturbations_; }
+
+    /** Get the number of variable-depth search chains built. */
+    inline Counter number_of_variable_depth_search_chains() const { return number_of_variable_depth_search_chains_; }
+
+    /** Get the number of variable-depth search chains which improved the solution. */
+    inline Counter number_of_improving_variable_depth_search_chains() const { return number_of_improving_variable_depth_search_chains_; }
+
     /*
      * Outputs
      */
@@ -402,8 +1247,6 @@ public:
 
     inline void write(const Solution&, std::string) const { return; }
 
-private:
-
     /*
      * Manipulate solutions
      */
@@ -481,69 +1324,2240 @@ private:
         return gc;
     }
 
-    /*
-     * Private attributes
+    /**
+     * Get the candidate agents of an item, that is, the agents with the
+     * smallest costs for this item.
+     *
+     * Only available if the ejection chain neighborhood is enabled.
      */
+    inline const std::vector<AgentIdx>& candidate_agents(ItemIdx item_id) const { return candidate_agents_[item_id]; }
 
-    /** Instance. */
-    const Instance& instance_;
+private:
 
-    /** Parameters. */
-    Parameters parameters_;
+    /** Get the overweight of an agent given its weight. */
+    inline Weight agent_overweight(
+            AgentIdx agent_id,
+            Weight weight) const
+    {
+        return (std::max)((Weight)0, weight - instance_.capacity(agent_id));
+    }
 
-    std::vector<AgentIdx> agents_;
+    /**
+     * Get the global cost of an overweight difference of an agent.
+     *
+     * See 'global_cost(solution, penalties)'.
+     */
+    inline GlobalCost overweight_cost(
+            const std::vector<Cost>& penalties,
+            AgentIdx agent_id,
+            Weight overweight_difference) const
+    {
+        if (penalties.empty())
+            return {overweight_difference, 0};
+        return {0, penalties[agent_id] * overweight_difference};
+    }
 
-};
+    /**
+     * Get the cost difference of removing an assigned item from its agent.
+     *
+     * The solution is not modified.
+     */
+    inline GlobalCost cost_remove(
+            const Solution& solution,
+            ItemIdx item_id,
+            const std::vector<Cost>& penalties) const
+    {
+        AgentIdx agent_id = solution.agents[item_id];
+        assert(agent_id != -1);
+        Weight weight = solution.weights[agent_id];
+        return overweight_cost(
+                penalties,
+                agent_id,
+                agent_overweight(agent_id, weight - instance_.weight(item_id, agent_id))
+                - agent_overweight(agent_id, weight))
+            + GlobalCost{0, -instance_.cost(item_id, agent_id)};
+    }
 
-const generalizedassignmentsolver::Output generalizedassignmentsolver::local_search(
-        const Instance& instance,
-        std::mt19937_64& generator,
-        const LocalSearchParameters& parameters)
-{
-    Output output(instance);
-    AlgorithmFormatter algorithm_formatter(parameters, output);
-    algorithm_formatter.start("Local search");
-    algorithm_formatter.print_header();
+    /**
+     * Get the cost difference of adding an unassigned item to an agent.
+     *
+     * The solution is not modified.
+     */
+    inline GlobalCost cost_add_difference(
+            const Solution& solution,
+            ItemIdx item_id,
+            AgentIdx agent_id,
+            const std::vector<Cost>& penalties) const
+    {
+        Weight weight = solution.weights[agent_id];
+        return overweight_cost(
+                penalties,
+                agent_id,
+                agent_overweight(agent_id, weight + instance_.weight(item_id, agent_id))
+                - agent_overweight(agent_id, weight))
+            + GlobalCost{0, instance_.cost(item_id, agent_id)};
+    }
 
-    // Create LocalScheme.
-    LocalScheme::Parameters parameters_local_scheme;
-    LocalScheme local_scheme(instance, parameters_local_scheme);
+    /**
+     * Replace the best shift move of an item by the shift move of this item
+     * toward an agent if the latter is improving and better.
+     *
+     * 'c_remove' is the cost difference of removing the item from its
+     * current agent.
+     */
+    inline void update_best_shift_move(
+            const Solution& solution,
+            ItemIdx item_id,
+            const GlobalCost& c_remove,
+            AgentIdx agent_id,
+            const std::vector<Cost>& penalties,
+            MoveShift& move) const
+    {
+        AgentIdx agent_id_old = solution.agents[item_id];
+        if (agent_id == agent_id_old)
+            return;
+        GlobalCost cost_difference = c_remove
+            + cost_add_difference(solution, item_id, agent_id, penalties);
+        if (cost_difference >= GlobalCost())
+            return;
+        if (move.agent_id != -1 && cost_difference >= move.cost_difference)
+            return;
+        move.item_id = item_id;
+        move.agent_id_old = agent_id_old;
+        move.agent_id = agent_id;
+        move.cost_difference = cost_difference;
+    }
 
-    // Run best first local search.
-    BestFirstLocalSearchParameters<LocalScheme> lssbfls_parameters;
-    lssbfls_parameters.verbosity_level = 0;
-    lssbfls_parameters.timer = parameters.timer;
-    lssbfls_parameters.number_of_threads_1 = 1;
-    lssbfls_parameters.number_of_threads_2 = parameters.number_of_threads;
-    lssbfls_parameters.maximum_number_of_nodes = parameters.maximum_number_of_nodes;
-    if (parameters.initial_solution == nullptr) {
-        lssbfls_parameters.initial_solution_ids = std::vector<Counter>(
-                lssbfls_parameters.number_of_threads_2, 0);
-    } else {
-        LocalScheme::Solution solution = local_scheme.solution(*parameters.initial_solution, generator);
-        lssbfls_parameters.initial_solution_ids = {};
-        lssbfls_parameters.initial_solutions = {solution};
+    /**
+     * Replace the best shift move of an item and update the heap and the
+     * agent back-pointers.
+     */
+    inline void set_best_shift_move(
+            ShiftMoves& shift_moves,
+            ItemIdx item_id,
+            const MoveShift& move) const
+    {
+        MoveShift& move_cur = shift_moves.best_moves[item_id];
+        if (move_cur.agent_id != -1) {
+            std::vector<ItemIdx>& items = shift_moves.agents_targeting_items[move_cur.agent_id];
+            ItemPos pos = shift_moves.targeting_positions[item_id];
+            items[pos] = items.back();
+            shift_moves.targeting_positions[items[pos]] = pos;
+            items.pop_back();
+            shift_moves.targeting_positions[item_id] = -1;
+        }
+        move_cur = move;
+        if (move.agent_id == -1) {
+            shift_moves.heap.erase(item_id);
+        } else {
+            std::vector<ItemIdx>& items = shift_moves.agents_targeting_items[move.agent_id];
+            shift_moves.targeting_positions[item_id] = items.size();
+            items.push_back(item_id);
+            shift_moves.heap.update(item_id, move.cost_difference);
+        }
     }
-    lssbfls_parameters.new_solution_callback
-        = [&instance, &algorithm_formatter](
-                const localsearchsolver::Output<LocalScheme>& lss_output)
-        {
-            const localsearchsolver::BestFirstLocalSearchOutput<LocalScheme>& lssbfls_output
-                = static_cast<const localsearchsolver::BestFirstLocalSearchOutput<LocalScheme>&>(lss_output);
-            const LocalScheme::Solution& lss_solution = lss_output.solution_pool.best();
-            Solution solution(instance);
-            for (ItemIdx item_id = 0;
-                    item_id < instance.number_of_items();
-                    ++item_id) {
-                AgentIdx agent_id = lss_solution.agents[item_id];
-                solution.set(item_id, agent_id);
+
+    /**
+     * Compute the best improving shift move of an item.
+     *
+     * The overweight differences toward all agents are computed at once.
+     */
+    inline void compute_best_shift_move(
+            const Solution& solution,
+            ItemIdx item_id,
+            const std::vector<Cost>& penalties,
+            std::vector<Weight>& overweight_differences,
+            ShiftMoves& shift_moves) const
+    {
+        MoveShift move;
+        GlobalCost c_remove = cost_remove(solution, item_id, penalties);
+        AgentIdx agent_id_old = solution.agents[item_id];
+        overweight_differences_(
+                instance_.number_of_agents(),
+                solution.weights.data(),
+                capacities_.data(),
+                weights_.data() + item_id * instance_.number_of_agents(),
+                overweight_differences.data());
+        const std::vector<Alternative>& alternatives = instance_.item(item_id).alternatives;
+        for (AgentIdx agent_id = 0;
+                agent_id < instance_.number_of_agents();
+                ++agent_id) {
+            if (agent_id == agent_id_old)
+                continue;
+            GlobalCost cost_difference = c_remove
+                + overweight_cost(penalties, agent_id, overweight_differences[agent_id])
+                + GlobalCost{0, alternatives[agent_id].cost};
+            if (cost_difference >= GlobalCost())
+                continue;
+            if (move.agent_id != -1 && cost_difference >= move.cost_difference)
+                continue;
+            move.item_id = item_id;
+            move.agent_id_old = agent_id_old;
+            move.agent_id = agent_id;
+            move.cost_difference = cost_difference;
+        }
+        set_best_shift_move(shift_moves, item_id, move);
+    }
+
+    /**
+     * Compute the best improving swap move between the items of two agents.
+     *
+     * With the lexicographic global cost, if both agents are within their
+     * capacities, a swap move can only be improving if both agents remain
+     * within their capacities. Since the
+     * items of the second agent are sorted by decreasing weight, once the
+     * weight of the second item gets too small for the first item to fit
+     * into the second agent, the remaining items can be skipped.
+     */
+    inline void compute_best_swap_move(
+            const Solution& solution,
+            const std::vector<std::vector<ItemIdx>>& agents_items,
+            const std::vector<Cost>& penalties,
+            AgentIdx agent_id_1,
+            AgentIdx agent_id_2,
+            MoveSwap& move) const
+    {
+        move.item_id_1 = -1;
+        Weight weight_1 = solution.weights[agent_id_1];
+        Weight weight_2 = solution.weights[agent_id_2];
+        Weight overweight_1 = agent_overweight(agent_id_1, weight_1);
+        Weight overweight_2 = agent_overweight(agent_id_2, weight_2);
+        Weight slack_1 = instance_.capacity(agent_id_1) - weight_1;
+        Weight slack_2 = instance_.capacity(agent_id_2) - weight_2;
+        bool prune = (penalties.empty() && slack_1 >= 0 && slack_2 >= 0);
+        for (ItemIdx item_id_1: agents_items[agent_id_1]) {
+            Weight w11 = instance_.weight(item_id_1, agent_id_1);
+            Weight w12 = instance_.weight(item_id_1, agent_id_2);
+            Cost c11 = instance_.cost(item_id_1, agent_id_1);
+            Cost c12 = instance_.cost(item_id_1, agent_id_2);
+            for (ItemIdx item_id_2: agents_items[agent_id_2]) {
+                Weight w22 = instance_.weight(item_id_2, agent_id_2);
+                if (prune && w12 - w22 > slack_2)
+                    break;
+                Weight w21 = instance_.weight(item_id_2, agent_id_1);
+                if (prune && w21 - w11 > slack_1)
+                    continue;
+                GlobalCost cost_difference
+                    = overweight_cost(
+                            penalties,
+                            agent_id_1,
+                            agent_overweight(agent_id_1, weight_1 - w11 + w21) - overweight_1)
+                    + overweight_cost(
+                            penalties,
+                            agent_id_2,
+                            agent_overweight(agent_id_2, weight_2 - w22 + w12) - overweight_2)
+                    + GlobalCost{
+                        0,
+                        c12 + instance_.cost(item_id_2, agent_id_1)
+                            - c11 - instance_.cost(item_id_2, agent_id_2)};
+                if (cost_difference >= GlobalCost())
+                    continue;
+                if (move.item_id_1 != -1 && cost_difference >= move.cost_difference)
+                    continue;
+                move.item_id_1 = item_id_1;
+                move.item_id_2 = item_id_2;
+                move.agent_id_1 = agent_id_1;
+                move.agent_id_2 = agent_id_2;
+                move.cost_difference = cost_difference;
+            }
+        }
+    }
+
+    /**
+     * Build an ejection chain starting from an item and replace the best
+     * ejection chain if one of its prefixes is improving and better.
+     *
+     * The chain is built greedily: at each step, the current item is
+     * inserted into one of its candidate agents and the item of this agent
+     * leading to the best partial cost is ejected. The partial cost includes
+     * the minimum cost of the ejected item, which is a lower bound on the
+     * cost of reinserting it. Each prefix of the chain is closed by
+     * inserting its last item into its best candidate agent.
+     *
+     * The moves are applied to the solution while the chain is built, which
+     * keeps the agent weights up to date, and undone at the end.
+     *
+     * 'moved' must be filled with '0' and is restored on exit. 'chain' is
+     * a buffer.
+     */
+    inline void update_best_ejection_chain(
+            Solution& solution,
+            const std::vector<std::vector<ItemIdx>>& agents_items,
+            const std::vector<Cost>& penalties,
+            ItemIdx item_id_start,
+            std::vector<uint8_t>& moved,
+            std::vector<std::tuple<ItemIdx, AgentIdx, AgentIdx>>& chain,
+            MoveEjectionChain& chain_best) const
+    {
+        // Continuation moves applied to the solution.
+        chain.clear();
+        ItemIdx item_id = item_id_start;
+        AgentIdx agent_id_old = solution.agents[item_id];
+        moved[item_id] = 1;
+        // Cost difference between the current partial solution and the
+        // initial solution.
+        GlobalCost c_cur = cost_remove(solution, item_id, penalties);
+        remove(solution, item_id);
+        for (ItemIdx depth = 0;
+                depth < parameters_.ejection_chain_maximum_depth;
+                ++depth) {
+            AgentIdx agent_id_close = -1;
+            GlobalCost c_close = worst<GlobalCost>();
+            AgentIdx agent_id_next = -1;
+            ItemIdx item_id_next = -1;
+            GlobalCost c_next = worst<GlobalCost>();
+            for (AgentIdx agent_id: candidate_agents_[item_id]) {
+                if (agent_id == agent_id_old)
+                    continue;
+
+                // Close the chain.
+                GlobalCost c = c_cur + cost_add_difference(
+                        solution, item_id, agent_id, penalties);
+                if (c < c_close) {
+                    agent_id_close = agent_id;
+                    c_close = c;
+                }
+
+                // Eject an item.
+                if (depth == parameters_.ejection_chain_maximum_depth - 1)
+                    continue;
+                Weight weight = solution.weights[agent_id]
+                    + instance_.weight(item_id, agent_id);
+                Weight overweight = agent_overweight(agent_id, solution.weights[agent_id]);
+                Cost cost = instance_.cost(item_id, agent_id);
+                for (ItemIdx item_id_2: agents_items[agent_id]) {
+                    if (moved[item_id_2])
+                        continue;
+                    GlobalCost c2 = c_cur
+                        + overweight_cost(
+                                penalties,
+                                agent_id,
+                                agent_overweight(agent_id, weight - instance_.weight(item_id_2, agent_id))
+                                - overweight)
+                        + GlobalCost{
+                            0,
+                            cost - instance_.cost(item_id_2, agent_id)
+                                + instance_.item(item_id_2).minimum_cost};
+                    if (c2 < c_next) {
+                        agent_id_next = agent_id;
+                        item_id_next = item_id_2;
+                        c_next = c2;
+                    }
+                }
+            }
+
+            // Update best chain.
+            if (agent_id_close != -1
+                    && c_close < GlobalCost()
+                    && (chain_best.moves.empty()
+                        || c_close < chain_best.cost_difference)) {
+                chain_best.moves.assign(chain.begin(), chain.end());
+                chain_best.moves.push_back({item_id, agent_id_old, agent_id_close});
+                chain_best.cost_difference = c_close;
+            }
+
+            if (item_id_next == -1)
+                break;
+            c_cur = c_cur + cost_add_difference(
+                    solution, item_id, agent_id_next, penalties);
+            add(solution, item_id, agent_id_next);
+            chain.push_back({item_id, agent_id_old, agent_id_next});
+            item_id = item_id_next;
+            agent_id_old = solution.agents[item_id];
+            moved[item_id] = 1;
+            c_cur = c_cur + cost_remove(solution, item_id, penalties);
+            remove(solution, item_id);
+        }
+
+        // Restore the solution.
+        add(solution, item_id, agent_id_old);
+        moved[item_id] = 0;
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            remove(solution, std::get<0>(*it));
+            add(solution, std::get<0>(*it), std::get<1>(*it));
+            moved[std::get<0>(*it)] = 0;
+        }
+    }
+
+    /**
+     * Variable-depth search.
+     *
+     * A chain of shift moves is built from the solution, each item being
+     * moved at most once. At each step, the best admissible shift move is
+     * applied, even if it worsens the solution. A move is admissible if the
+     * cost of the solution after the move is smaller than the cost of the
+     * initial solution (gain criterion); the overweight may increase
+     * temporarily. Once the solution has some overweight, only the items of
+     * overweighted agents are moved.
+     *
+     * The 'variable_depth_search_breadth' best moves are tried at the first
+     * two levels of the chain; deeper levels are greedy. When a chain can't
+     * be extended anymore, its best prefix is applied if it improves the
+     * initial solution.
+     *
+     * The search is deterministic.
+     *
+     * Return 'true' if the solution has been improved.
+     */
+    inline bool variable_depth_search(
+            Solution& solution,
+            Workspace& workspace)
+    {
+        if (solution.overweight > 0)
+            return false;
+        number_of_variable_depth_search_chains_++;
+        workspace.chain.clear();
+        workspace.variable_depth_search_global_costs.clear();
+        bool improved = variable_depth_search_extend(
+                solution,
+                global_cost(solution),
+                workspace);
+        // Whether the chain has been applied or discarded, its items may be
+        // moved again by the next chains.
+        assert(std::find(
+                    workspace.moved.begin(),
+                    workspace.moved.end(),
+                    1) == workspace.moved.end());
+        if (improved)
+            number_of_improving_variable_depth_search_chains_++;
+        return improved;
+    }
+
+    /**
+     * Extend the current variable-depth search chain.
+     *
+     * If the chain is improving, its best prefix is applied to the solution,
+     * the chain is cleared and 'true' is returned. Otherwise, the solution
+     * and the chain are left unchanged.
+     */
+    inline bool variable_depth_search_extend(
+            Solution& solution,
+            const GlobalCost& global_cost_start,
+            Workspace& workspace) const
+    {
+        std::vector<std::tuple<ItemIdx, AgentIdx, AgentIdx>>& chain = workspace.chain;
+        std::vector<GlobalCost>& global_costs = workspace.variable_depth_search_global_costs;
+        ItemIdx level = chain.size();
+        std::vector<MoveVariableDepthSearch>& moves
+            = workspace.variable_depth_search_moves[(std::min)(level, (ItemIdx)2)];
+        if (level < parameters_.variable_depth_search_maximum_depth) {
+            variable_depth_search_moves(
+                    solution,
+                    global_cost_start,
+                    (level < 2)? parameters_.variable_depth_search_breadth: 1,
+                    workspace.moved,
+                    moves);
+        } else {
+            moves.clear();
+        }
+
+        if (moves.empty()) {
+            // The chain can't be extended; look for its best prefix.
+            ItemIdx length_best = 0;
+            GlobalCost global_cost_best = global_cost_start;
+            for (ItemIdx length = 1; length <= level; ++length) {
+                if (global_costs[length - 1] < global_cost_best) {
+                    length_best = length;
+                    global_cost_best = global_costs[length - 1];
+                }
+            }
+            if (length_best == 0)
+                return false;
+            // Undo the moves after the best prefix.
+            while ((ItemIdx)chain.size() > length_best) {
+                ItemIdx item_id = std::get<0>(chain.back());
+                remove(solution, item_id);
+                add(solution, item_id, std::get<1>(chain.back()));
+                workspace.moved[item_id] = 0;
+                chain.pop_back();
+            }
+            for (const auto& move: chain)
+                workspace.moved[std::get<0>(move)] = 0;
+            chain.clear();
+            global_costs.clear();
+            return true;
+        }
+
+        for (Counter move_pos = 0; move_pos < (Counter)moves.size(); ++move_pos) {
+            // 'moves' may be overwritten by the deeper levels.
+            MoveVariableDepthSearch move = moves[move_pos];
+            AgentIdx agent_id_old = solution.agents[move.item_id];
+            remove(solution, move.item_id);
+            add(solution, move.item_id, move.agent_id);
+            workspace.moved[move.item_id] = 1;
+            chain.push_back({move.item_id, agent_id_old, move.agent_id});
+            global_costs.push_back(move.global_cost);
+
+            if (variable_depth_search_extend(solution, global_cost_start, workspace))
+                return true;
+
+            remove(solution, move.item_id);
+            add(solution, move.item_id, agent_id_old);
+            workspace.moved[move.item_id] = 0;
+            chain.pop_back();
+            global_costs.pop_back();
+        }
+        return false;
+    }
+
+    /**
+     * Compute the 'breadth' best admissible shift moves of a variable-depth
+     * search chain, sorted by global cost.
+     */
+    inline void variable_depth_search_moves(
+            const Solution& solution,
+            const GlobalCost& global_cost_start,
+            Counter breadth,
+            const std::vector<uint8_t>& moved,
+            std::vector<MoveVariableDepthSearch>& moves) const
+    {
+        moves.clear();
+        for (ItemIdx item_id = 0;
+                item_id < instance_.number_of_items();
+                ++item_id) {
+            if (moved[item_id])
+                continue;
+            AgentIdx agent_id_old = solution.agents[item_id];
+            Weight weight_old = solution.weights[agent_id_old];
+            Weight overweight_old = agent_overweight(agent_id_old, weight_old);
+            if (solution.overweight > 0 && overweight_old == 0)
+                continue;
+            Weight overweight_remove = agent_overweight(
+                    agent_id_old,
+                    weight_old - instance_.weight(item_id, agent_id_old))
+                - overweight_old;
+            Cost cost_remove = solution.cost - instance_.cost(item_id, agent_id_old);
+            for (AgentIdx agent_id = 0;
+                    agent_id < instance_.number_of_agents();
+                    ++agent_id) {
+                if (agent_id == agent_id_old)
+                    continue;
+                Cost cost = cost_remove + instance_.cost(item_id, agent_id);
+                // Gain criterion.
+                if (cost >= std::get<1>(global_cost_start))
+                    continue;
+                Weight weight = solution.weights[agent_id];
+                GlobalCost gc = {
+                    solution.overweight + overweight_remove
+                        + agent_overweight(agent_id, weight + instance_.weight(item_id, agent_id))
+                        - agent_overweight(agent_id, weight),
+                    cost};
+                if ((Counter)moves.size() == breadth
+                        && !(gc < moves.back().global_cost)) {
+                    continue;
+                }
+                MoveVariableDepthSearch move;
+                move.item_id = item_id;
+                move.agent_id = agent_id;
+                move.global_cost = gc;
+                auto pos = std::upper_bound(
+                        moves.begin(),
+                        moves.end(),
+                        move,
+                        [](
+                            const MoveVariableDepthSearch& move_1,
+                            const MoveVariableDepthSearch& move_2)
+                        {
+                            return move_1.global_cost < move_2.global_cost;
+                        }) - moves.begin();
+                if ((Counter)moves.size() == breadth)
+                    moves.pop_back();
+                moves.insert(moves.begin() + pos, move);
+            }
+        }
+    }
+
+    /** Remove an item from the sorted list of items of an agent. */
+    inline void remove_agent_item(
+            std::vector<std::vector<ItemIdx>>& agents_items,
+            AgentIdx agent_id,
+            ItemIdx item_id) const
+    {
+        std::vector<ItemIdx>& items = agents_items[agent_id];
+        items.erase(std::find(items.begin(), items.end(), item_id));
+    }
+
+    /** Insert an item into the sorted list of items of an agent. */
+    inline void add_agent_item(
+            std::vector<std::vector<ItemIdx>>& agents_items,
+            AgentIdx agent_id,
+            ItemIdx item_id) const
+    {
+        std::vector<ItemIdx>& items = agents_items[agent_id];
+        Weight weight = instance_.weight(item_id, agent_id);
+        auto it = std::find_if(
+                items.begin(),
+                items.end(),
+                [this, agent_id, weight](ItemIdx item_id_2)
+                {
+                    return instance_.weight(item_id_2, agent_id) < weight;
+                });
+        items.insert(it, item_id);
+    }
+
+    /** Get a workspace, creating it if none is available. */
+    std::unique_ptr<Workspace> acquire_workspace()
+    {
+        std::lock_guard<std::mutex> lock(workspaces_mutex_);
+        std::unique_ptr<Workspace> workspace;
+        if (workspaces_.empty()) {
+            workspace = std::unique_ptr<Workspace>(new Workspace(instance_));
+            number_of_workspace_buffer_allocations_++;
+        } else {
+            workspace = std::move(workspaces_.back());
+            workspaces_.pop_back();
+        }
+        workspace->penalties.assign(penalties_.begin(), penalties_.end());
+        workspace->acquired_capacity = workspace->capacity();
+        return workspace;
+    }
+
+    /**
+     * Give back a workspace.
+     *
+     * If some of its buffers have grown, it counts as a buffer allocation.
+     */
+    void release_workspace(std::unique_ptr<Workspace> workspace)
+    {
+        bool has_grown = (workspace->capacity() > workspace->acquired_capacity);
+        std::lock_guard<std::mutex> lock(workspaces_mutex_);
+        if (has_grown)
+            number_of_workspace_buffer_allocations_++;
+        workspaces_.push_back(std::move(workspace));
+    }
+
+    /**
+     * Update the penalties from a local optimum of the penalized global cost.
+     *
+     * The penalty of each violated agent is increased and the penalty of
+     * each other agent is decreased. Thus, the agents which are frequently
+     * violated get high penalties.
+     *
+     * The penalties are bounded by the sum of all the costs plus one: with
+     * such a penalty, removing an overweight unit is better than any change
+     * of cost, and the penalized cost does not overflow on instances where
+     * some agents always remain violated.
+     */
+    void update_penalties(const Solution& solution)
+    {
+        std::lock_guard<std::mutex> lock(workspaces_mutex_);
+        for (AgentIdx agent_id = 0;
+                agent_id < instance_.number_of_agents();
+                ++agent_id) {
+            Cost& penalty = penalties_[agent_id];
+            if (solution.weights[agent_id] > instance_.capacity(agent_id)) {
+                penalty = (std::min)(
+                        instance_.total_cost() + 1,
+                        penalty + (std::max)((Cost)1, penalty / 4));
+            } else {
+                penalty = (std::max)((Cost)1, penalty - penalty / 8);
             }
-            std::stringstream ss;
-            ss << "node " << lssbfls_output.number_of_nodes;
-            algorithm_formatter.update_solution(solution, ss.str());
+        }
+    }
+
+    /** Check that the cost of a solution after a move is the expected one. */
+    inline void check_cost(
+            const Solution& solution,
+            const std::vector<Cost>& penalties,
+            const GlobalCost& c_cur,
+            const GlobalCost& cost_difference) const
+    {
+        if (global_cost(solution, penalties) != c_cur + cost_difference) {
+            throw std::logic_error("Costs do not match:\n"
+                    "* Current cost: " + to_string(c_cur) + "\n"
+                    + "* Move cost difference: " + to_string(cost_difference) + "\n"
+                    + "* Expected new cost: " + to_string(c_cur + cost_difference) + "\n"
+                    + "* Actual new cost: " + to_string(global_cost(solution, penalties)) + "\n");
+        }
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Parameters. */
+    Parameters parameters_;
+
+    std::vector<AgentIdx> agents_;
+
+    /** Capacities of the agents. */
+    std::vector<Weight> capacities_;
+
+    /** Weights, item-major: 'weights_[item_id * m + agent_id]'. */
+    std::vector<Weight> weights_;
+
+    /** Implementation of the overweight differences kernel. */
+    OverweightDifferencesFunction overweight_differences_;
+
+    /** For each item, candidate agents of the ejection chain neighborhood. */
+    std::vector<std::vector<AgentIdx>> candidate_agents_;
+
+    /** Workspaces which are not used by a running local search. */
+    std::vector<std::unique_ptr<Workspace>> workspaces_;
+
+    /**
+     * Penalties of the overweight of each agent in the penalized global
+     * cost.
+     */
+    std::vector<Cost> penalties_;
+
+    /**
+     * Mutex protecting 'workspaces_', 'penalties_' and
+     * 'number_of_workspace_buffer_allocations_'.
+     */
+    std::mutex workspaces_mutex_;
+
+    /** Number of buffer allocations of the workspaces. */
+    Counter number_of_workspace_buffer_allocations_ = 0;
+
+    /** Number of duplicate perturbations drawn again. */
+    std::atomic<Counter> number_of_duplicate_perturbations_{0};
+
+    /** Number of variable-depth search chains built. */
+    std::atomic<Counter> number_of_variable_depth_search_chains_{0};
+
+    /** Number of variable-depth search chains which improved the solution. */
+    std::atomic<Counter> number_of_improving_variable_depth_search_chains_{0};
+
+};
+
+namespace
+{
+
+/** Convert a solution of the local scheme into a solution. */
+Solution local_scheme_to_solution(
+        const Instance& instance,
+        const LocalScheme::Solution& lss_solution)
+{
+    Solution solution(instance);
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        AgentIdx agent_id = lss_solution.agents[item_id];
+        solution.set(item_id, agent_id);
+    }
+    return solution;
+}
+
+/** Entry of a solution slot shared by the threads of the local search. */
+struct LocalSearchSlotEntry
+{
+    LocalScheme::Solution solution;
+
+    LocalScheme::GlobalCost global_cost;
+};
+
+using LocalSearchSlot = std::shared_ptr<const LocalSearchSlotEntry>;
+
+/** Data shared by the threads of the local search. */
+struct LocalSearchSharedData
+{
+    /**
+     * Best solution found so far.
+     *
+     * It is only accessed through 'std::atomic_load' and
+     * 'std::atomic_compare_exchange_strong'.
+     */
+    LocalSearchSlot best;
+
+    /**
+     * Best solution of each thread, from which the other threads import
+     * elite solutions.
+     *
+     * They are only accessed through 'std::atomic_load' and
+     * 'std::atomic_store'.
+     */
+    std::vector<LocalSearchSlot> elites;
+
+    /** Mutex protecting the algorithm formatter. */
+    std::mutex mutex;
+
+    /** Total number of nodes. */
+    std::atomic<Counter> number_of_nodes{0};
+
+    /** Number of elite solutions imported from another thread. */
+    std::atomic<Counter> number_of_elite_imports{0};
+};
+
+/**
+ * Publish a solution in the best solution slot.
+ *
+ * Return 'true' if it is better than the previous best solution.
+ */
+bool local_search_publish_best(
+        LocalSearchSharedData& shared_data,
+        const LocalSearchSlot& entry)
+{
+    LocalSearchSlot best = std::atomic_load(&shared_data.best);
+    while (best == nullptr || entry->global_cost < best->global_cost) {
+        if (std::atomic_compare_exchange_strong(&shared_data.best, &best, entry))
+            return true;
+    }
+    return false;
+}
+
+void local_search_worker(
+        const Instance& instance,
+        LocalScheme& local_scheme,
+        const LocalSearchParameters& parameters,
+        const std::vector<LocalScheme::Solution>& initial_solutions,
+        Seed seed,
+        Counter thread_id,
+        LocalSearchSharedData& shared_data,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    std::mt19937_64 generator(seed);
+    Counter number_of_threads = shared_data.elites.size();
+    std::vector<LocalScheme::Solution> solutions = initial_solutions;
+    if (solutions.empty())
+        solutions.push_back(local_scheme.initial_solution(0, generator));
+
+    for (;;) {
+        if (parameters.timer.needs_to_end())
+            break;
+
+        // Number of nodes of this epoch. With a single thread, the best
+        // first local search runs in a single epoch.
+        Counter maximum_number_of_nodes = -1;
+        if (number_of_threads > 1)
+            maximum_number_of_nodes = parameters.elite_import_interval;
+        // With a maximum number of nodes, the nodes of the epoch are
+        // reserved beforehand, and the unused ones are given back after.
+        if (parameters.maximum_number_of_nodes != -1) {
+            if (maximum_number_of_nodes == -1)
+                maximum_number_of_nodes = parameters.maximum_number_of_nodes;
+            Counter number_of_nodes = shared_data.number_of_nodes.fetch_add(
+                    maximum_number_of_nodes);
+            Counter number_of_remaining_nodes
+                = parameters.maximum_number_of_nodes - number_of_nodes;
+            if (number_of_remaining_nodes < maximum_number_of_nodes) {
+                shared_data.number_of_nodes -= maximum_number_of_nodes
+                    - (std::max)((Counter)0, number_of_remaining_nodes);
+                maximum_number_of_nodes = number_of_remaining_nodes;
+            }
+            if (maximum_number_of_nodes <= 0)
+                break;
+        }
+
+        BestFirstLocalSearchParameters<LocalScheme> lssbfls_parameters;
+        lssbfls_parameters.verbosity_level = 0;
+        lssbfls_parameters.timer = parameters.timer;
+        lssbfls_parameters.seed = generator();
+        lssbfls_parameters.number_of_threads_1 = 1;
+        lssbfls_parameters.number_of_threads_2 = 1;
+        lssbfls_parameters.maximum_number_of_nodes = maximum_number_of_nodes;
+        lssbfls_parameters.initial_solution_ids = {};
+        lssbfls_parameters.initial_solutions = solutions;
+        lssbfls_parameters.new_solution_callback
+            = [&instance, &local_scheme, thread_id, &shared_data, &algorithm_formatter](
+                    const localsearchsolver::Output<LocalScheme>& lss_output)
+            {
+                const localsearchsolver::BestFirstLocalSearchOutput<LocalScheme>& lssbfls_output
+                    = static_cast<const localsearchsolver::BestFirstLocalSearchOutput<LocalScheme>&>(lss_output);
+                const LocalScheme::Solution& lss_solution = lss_output.solution_pool.best();
+                LocalSearchSlot entry = std::make_shared<const LocalSearchSlotEntry>(
+                        LocalSearchSlotEntry{lss_solution, local_scheme.global_cost(lss_solution)});
+                std::atomic_store(&shared_data.elites[thread_id], entry);
+                if (!local_search_publish_best(shared_data, entry))
+                    return;
+                std::lock_guard<std::mutex> lock(shared_data.mutex);
+                // Another thread may have published a better solution in
+                // the meantime; the algorithm formatter ignores it then.
+                std::stringstream ss;
+                ss << "thread " << thread_id << " node " << lssbfls_output.number_of_nodes;
+                algorithm_formatter.update_solution(
+                        local_scheme_to_solution(instance, lss_solution),
+                        ss.str());
+            };
+        auto lssbfls_output = best_first_local_search(local_scheme, lssbfls_parameters);
+        if (parameters.maximum_number_of_nodes != -1) {
+            shared_data.number_of_nodes -= maximum_number_of_nodes
+                - lssbfls_output.number_of_nodes;
+        } else {
+            shared_data.number_of_nodes += lssbfls_output.number_of_nodes;
+        }
+        if (number_of_threads == 1)
+            break;
+
+        // Next epoch: start from the best solution of the thread and from
+        // the best solution of another random thread.
+        solutions = {lssbfls_output.solution_pool.best()};
+        std::uniform_int_distribution<Counter> d_thread(0, number_of_threads - 2);
+        Counter thread_id_2 = d_thread(generator);
+        if (thread_id_2 >= thread_id)
+            thread_id_2++;
+        LocalSearchSlot elite = std::atomic_load(&shared_data.elites[thread_id_2]);
+        if (elite != nullptr && elite->solution.agents != solutions.front().agents) {
+            solutions.push_back(elite->solution);
+            shared_data.number_of_elite_imports++;
+        }
+    }
+}
+
+}
+
+const LocalSearchOutput generalizedassignmentsolver::local_search(
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const LocalSearchParameters& parameters)
+{
+    LocalSearchOutput output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Local search");
+    algorithm_formatter.print_header();
+
+    // Create LocalScheme.
+    LocalScheme::Parameters parameters_local_scheme;
+    parameters_local_scheme.adaptive_penalty = parameters.adaptive_penalty;
+    parameters_local_scheme.variable_depth_search_maximum_depth
+        = parameters.variable_depth_search_maximum_depth;
+    LocalScheme local_scheme(instance, parameters_local_scheme);
+
+    // Initial solution. It is only used by the first thread; the other
+    // threads start from random solutions.
+    std::vector<LocalScheme::Solution> initial_solutions;
+    if (parameters.initial_solution != nullptr
+            && parameters.initial_solution->number_of_items() > 0) {
+        initial_solutions.push_back(local_scheme.solution(
+                    *parameters.initial_solution,
+                    generator));
+    }
+
+    // Run cooperative best first local searches. Each thread has its own
+    // random stream, seeded from 'generator'.
+    Counter number_of_threads = (std::max)((Counter)1, parameters.number_of_threads);
+    LocalSearchSharedData shared_data;
+    shared_data.elites.resize(number_of_threads);
+    std::vector<Seed> seeds;
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
+        seeds.push_back(generator());
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1;
+            thread_id < number_of_threads;
+            ++thread_id) {
+        threads.push_back(std::thread(
+                    local_search_worker,
+                    std::ref(instance),
+                    std::ref(local_scheme),
+                    std::ref(parameters),
+                    std::vector<LocalScheme::Solution>(),
+                    seeds[thread_id],
+                    thread_id,
+                    std::ref(shared_data),
+                    std::ref(algorithm_formatter)));
+    }
+    local_search_worker(
+            instance,
+            local_scheme,
+            parameters,
+            initial_solutions,
+            seeds[0],
+            0,
+            shared_data,
+            algorithm_formatter);
+    for (std::thread& thread: threads)
+        thread.join();
+
+    output.number_of_workspace_buffer_allocations = local_scheme.number_of_workspace_buffer_allocations();
+    output.number_of_duplicate_perturbations = local_scheme.number_of_duplicate_perturbations();
+    output.number_of_nodes = shared_data.number_of_nodes;
+    output.number_of_elite_imports = shared_data.number_of_elite_imports;
+    output.number_of_variable_depth_search_chains
+        = local_scheme.number_of_variable_depth_search_chains();
+    output.number_of_improving_variable_depth_search_chains
+        = local_scheme.number_of_improving_variable_depth_search_chains();
+    algorithm_formatter.end();
+    return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////// Variable-depth search /////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+const VariableDepthSearchOutput generalizedassignmentsolver::variable_depth_search(
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const VariableDepthSearchParameters& parameters)
+{
+    VariableDepthSearchOutput output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Variable-depth search");
+    algorithm_formatter.print_header();
+
+    // Create LocalScheme.
+    LocalScheme::Parameters parameters_local_scheme;
+    parameters_local_scheme.variable_depth_search_maximum_depth
+        = (std::max)((ItemIdx)1, parameters.maximum_depth);
+    parameters_local_scheme.variable_depth_search_breadth
+        = (std::max)((Counter)1, parameters.breadth);
+    LocalScheme local_scheme(instance, parameters_local_scheme);
+
+    LocalScheme::Solution solution
+        = (parameters.initial_solution != nullptr
+                && parameters.initial_solution->number_of_items() > 0)?
+        local_scheme.solution(*parameters.initial_solution, generator):
+        local_scheme.initial_solution(0, generator);
+
+    // Descent followed by variable-depth search chains until no chain
+    // improves the solution.
+    local_scheme.local_search(solution, generator);
+
+    if (solution.overweight == 0) {
+        algorithm_formatter.update_solution(
+                local_scheme_to_solution(instance, solution),
+                "");
+    }
+
+    output.number_of_chains = local_scheme.number_of_variable_depth_search_chains();
+    output.number_of_improving_chains = local_scheme.number_of_improving_variable_depth_search_chains();
+    algorithm_formatter.end();
+    return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////// Tabu search //////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/** Move of the tabu search. */
+struct TabuSearchMove
+{
+    /** First item; '-1' if no move. */
+    ItemIdx item_id_1 = -1;
+
+    /** Second item for a swap move; '-1' for a shift move. */
+    ItemIdx item_id_2 = -1;
+
+    /** New agent of the first item. */
+    AgentIdx agent_id = -1;
+
+    /** Global cost of the solution after the move. */
+    LocalScheme::GlobalCost global_cost;
+
+    /** Penalized cost used to compare the moves. */
+    double score = std::numeric_limits<double>::infinity();
+};
+
+/** Data shared by the threads of the tabu search. */
+struct TabuSearchSharedData
+{
+    /** Best solution found so far. */
+    LocalScheme::Solution solution_best;
+
+    /** Mutex protecting 'solution_best' and the algorithm formatter. */
+    std::mutex mutex;
+
+    /** Total number of iterations. */
+    std::atomic<Counter> number_of_iterations{0};
+};
+
+/** Data of a thread of the tabu search. */
+struct TabuSearchThreadData
+{
+    TabuSearchThreadData(const Instance& instance):
+        tabu(instance.number_of_items() * instance.number_of_agents(), 0),
+        frequencies(instance.number_of_items() * instance.number_of_agents(), 0),
+        agents_items(instance.number_of_agents()),
+        positions(instance.number_of_items(), -1) { }
+
+    /**
+     * For each item and agent, the iteration until which moving the item to
+     * the agent is tabu.
+     */
+    std::vector<Counter> tabu;
+
+    /**
+     * For each item and agent, the number of times the item has been moved
+     * to the agent.
+     */
+    std::vector<Counter> frequencies;
+
+    /** Items of each agent. */
+    std::vector<std::vector<ItemIdx>> agents_items;
+
+    /** Position of each item in 'agents_items'. */
+    std::vector<ItemPos> positions;
+};
+
+void tabu_search_set_agents_items(
+        const LocalScheme::Solution& solution,
+        TabuSearchThreadData& data)
+{
+    for (std::vector<ItemIdx>& items: data.agents_items)
+        items.clear();
+    for (ItemIdx item_id = 0;
+            item_id < (ItemIdx)solution.agents.size();
+            ++item_id) {
+        std::vector<ItemIdx>& items = data.agents_items[solution.agents[item_id]];
+        data.positions[item_id] = items.size();
+        items.push_back(item_id);
+    }
+}
+
+void tabu_search_move_item(
+        LocalScheme& local_scheme,
+        LocalScheme::Solution& solution,
+        TabuSearchThreadData& data,
+        ItemIdx item_id,
+        AgentIdx agent_id)
+{
+    std::vector<ItemIdx>& items_old = data.agents_items[solution.agents[item_id]];
+    ItemPos pos = data.positions[item_id];
+    items_old[pos] = items_old.back();
+    data.positions[items_old[pos]] = pos;
+    items_old.pop_back();
+    data.positions[item_id] = data.agents_items[agent_id].size();
+    data.agents_items[agent_id].push_back(item_id);
+    local_scheme.remove(solution, item_id);
+    local_scheme.add(solution, item_id, agent_id);
+}
+
+void tabu_search_worker(
+        const Instance& instance,
+        LocalScheme& local_scheme,
+        const TabuSearchParameters& parameters,
+        Counter thread_id,
+        TabuSearchSharedData& shared_data,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    using GlobalCost = LocalScheme::GlobalCost;
+    std::mt19937_64 generator(parameters.seed + thread_id);
+    AgentIdx m = instance.number_of_agents();
+    TabuSearchThreadData data(instance);
+    Counter maximum_number_of_iterations_without_improvement
+        = (parameters.maximum_number_of_iterations_without_improvement != -1)?
+        parameters.maximum_number_of_iterations_without_improvement:
+        10 * instance.number_of_items();
+    std::uniform_int_distribution<Counter> d_tenure(0, parameters.tabu_tenure);
+
+    // Initial solution.
+    // Without initial solution, each item is assigned to one of its two
+    // cheapest agents before running a local search.
+    LocalScheme::Solution solution = local_scheme.empty_solution();
+    if (parameters.initial_solution != nullptr
+            && parameters.initial_solution->number_of_items() > 0) {
+        solution = local_scheme.solution(*parameters.initial_solution, generator);
+    } else {
+        for (ItemIdx item_id = 0;
+                item_id < instance.number_of_items();
+                ++item_id) {
+            const std::vector<AgentIdx>& agents = local_scheme.candidate_agents(item_id);
+            std::uniform_int_distribution<AgentPos> d_agent(
+                    0, (std::min)((AgentPos)agents.size(), (AgentPos)2) - 1);
+            AgentPos agent_pos = (thread_id == 0)? 0: d_agent(generator);
+            local_scheme.add(solution, item_id, agents[agent_pos]);
+        }
+    }
+    local_scheme.local_search(solution, generator);
+    tabu_search_set_agents_items(solution, data);
+    GlobalCost c_cur = local_scheme.global_cost(solution);
+    // Best global cost of the thread since the last restart.
+    GlobalCost c_best = c_cur;
+    // Best global cost of all threads, used for the aspiration criterion.
+    // It is only refreshed when the thread improves or restarts.
+    GlobalCost c_best_shared = worst<GlobalCost>();
+
+    // Publish the initial local optimum, since the first tabu moves usually
+    // worsen it.
+    {
+        std::lock_guard<std::mutex> lock(shared_data.mutex);
+        c_best_shared = local_scheme.global_cost(shared_data.solution_best);
+        if (c_cur < c_best_shared) {
+            shared_data.solution_best = solution;
+            c_best_shared = c_cur;
+            algorithm_formatter.update_solution(
+                    local_scheme_to_solution(instance, solution),
+                    "thread " + std::to_string(thread_id) + " initial solution");
+        }
+    }
+    Counter iteration_last_improvement = 0;
+    // Penalty of the overweight in the cost used to compare the moves.
+    double penalty_minimum = 1e-3;
+    double penalty_maximum = 1e3 * (instance.maximum_cost() + 1);
+    double penalty = (double)(instance.maximum_cost() + 1)
+        / (instance.maximum_weight() + 1);
+
+    for (Counter iteration = 1;; ++iteration) {
+        if (parameters.timer.needs_to_end())
+            break;
+        Counter number_of_iterations = shared_data.number_of_iterations++;
+        if (parameters.maximum_number_of_iterations != -1
+                && number_of_iterations >= parameters.maximum_number_of_iterations) {
+            shared_data.number_of_iterations--;
+            break;
+        }
+
+        // Restart from the best solution found so far.
+        if (iteration - iteration_last_improvement
+                > maximum_number_of_iterations_without_improvement) {
+            {
+                std::lock_guard<std::mutex> lock(shared_data.mutex);
+                solution = shared_data.solution_best;
+            }
+            tabu_search_set_agents_items(solution, data);
+            std::fill(data.tabu.begin(), data.tabu.end(), 0);
+            c_cur = local_scheme.global_cost(solution);
+            c_best = c_cur;
+            c_best_shared = c_cur;
+            iteration_last_improvement = iteration;
+        }
+
+        // Frequency penalty scale. A non-improving move toward an agent
+        // which the item has been moved to at each iteration would be
+        // penalized by 'diversification_factor * maximum_cost'.
+        double frequency_penalty = parameters.diversification_factor
+            * instance.maximum_cost() / iteration;
+        double score_cur = std::get<1>(c_cur) + penalty * std::get<0>(c_cur);
+
+        // Look for the best non-tabu move. A tabu move is allowed if it
+        // leads to a solution better than the best one found so far.
+        TabuSearchMove move_best;
+        auto evaluate = [&](
+                ItemIdx item_id_1,
+                ItemIdx item_id_2,
+                AgentIdx agent_id,
+                bool is_tabu,
+                const GlobalCost& c)
+        {
+            if (is_tabu && !(c < c_best && c < c_best_shared))
+                return;
+            double score = std::get<1>(c) + penalty * std::get<0>(c);
+            if (score >= score_cur) {
+                score += frequency_penalty
+                    * data.frequencies[item_id_1 * m + agent_id];
+            }
+            if (score >= move_best.score)
+                return;
+            move_best.item_id_1 = item_id_1;
+            move_best.item_id_2 = item_id_2;
+            move_best.agent_id = agent_id;
+            move_best.global_cost = c;
+            move_best.score = score;
         };
-    best_first_local_search(local_scheme, lssbfls_parameters);
+        for (ItemIdx item_id = 0;
+                item_id < instance.number_of_items();
+                ++item_id) {
+            AgentIdx agent_id_old = solution.agents[item_id];
+            local_scheme.remove(solution, item_id);
+
+            // Shift moves.
+            for (AgentIdx agent_id = 0; agent_id < m; ++agent_id) {
+                if (agent_id == agent_id_old)
+                    continue;
+                evaluate(
+                        item_id,
+                        -1,
+                        agent_id,
+                        data.tabu[item_id * m + agent_id] > iteration,
+                        local_scheme.cost_add(solution, item_id, agent_id));
+            }
+
+            // Swap moves with the items of the candidate agents of the item.
+            for (AgentIdx agent_id: local_scheme.candidate_agents(item_id)) {
+                if (agent_id == agent_id_old)
+                    continue;
+                bool is_tabu_1 = data.tabu[item_id * m + agent_id] > iteration;
+                local_scheme.add(solution, item_id, agent_id);
+                for (ItemIdx item_id_2: data.agents_items[agent_id]) {
+                    if (item_id_2 == item_id)
+                        continue;
+                    local_scheme.remove(solution, item_id_2);
+                    evaluate(
+                            item_id,
+                            item_id_2,
+                            agent_id,
+                            is_tabu_1 || data.tabu[item_id_2 * m + agent_id_old] > iteration,
+                            local_scheme.cost_add(solution, item_id_2, agent_id_old));
+                    local_scheme.add(solution, item_id_2, agent_id);
+                }
+                local_scheme.remove(solution, item_id);
+            }
+
+            local_scheme.add(solution, item_id, agent_id_old);
+        }
+        if (move_best.item_id_1 == -1)
+            continue;
+
+        // Apply move.
+        ItemIdx item_id_1 = move_best.item_id_1;
+        AgentIdx agent_id_1 = solution.agents[item_id_1];
+        Counter tenure = parameters.tabu_tenure + d_tenure(generator);
+        data.tabu[item_id_1 * m + agent_id_1] = iteration + tenure;
+        data.frequencies[item_id_1 * m + move_best.agent_id]++;
+        tabu_search_move_item(local_scheme, solution, data, item_id_1, move_best.agent_id);
+        if (move_best.item_id_2 != -1) {
+            ItemIdx item_id_2 = move_best.item_id_2;
+            data.tabu[item_id_2 * m + move_best.agent_id] = iteration + tenure;
+            data.frequencies[item_id_2 * m + agent_id_1]++;
+            tabu_search_move_item(local_scheme, solution, data, item_id_2, agent_id_1);
+        }
+        c_cur = move_best.global_cost;
+
+        // Strategic oscillation: the overweight penalty increases while the
+        // solution is infeasible and decreases while it is feasible.
+        if (std::get<0>(c_cur) > 0) {
+            penalty = (std::min)(penalty * 1.1, penalty_maximum);
+        } else {
+            penalty = (std::max)(penalty / 1.1, penalty_minimum);
+        }
+
+        // Update best solutions.
+        if (!(c_cur < c_best))
+            continue;
+        c_best = c_cur;
+        iteration_last_improvement = iteration;
+        if (!(c_cur < c_best_shared))
+            continue;
+        std::lock_guard<std::mutex> lock(shared_data.mutex);
+        c_best_shared = local_scheme.global_cost(shared_data.solution_best);
+        if (c_cur < c_best_shared) {
+            shared_data.solution_best = solution;
+            c_best_shared = c_cur;
+            algorithm_formatter.update_solution(
+                    local_scheme_to_solution(instance, solution),
+                    "thread " + std::to_string(thread_id)
+                    + " it " + std::to_string(iteration));
+        }
+    }
+}
+
+}
+
+const TabuSearchOutput generalizedassignmentsolver::tabu_search(
+        const Instance& instance,
+        const TabuSearchParameters& parameters)
+{
+    TabuSearchOutput output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Tabu search");
+    algorithm_formatter.print_header();
+
+    LocalScheme::Parameters parameters_local_scheme;
+    LocalScheme local_scheme(instance, parameters_local_scheme);
+
+    TabuSearchSharedData shared_data;
+    std::mt19937_64 generator(parameters.seed);
+    shared_data.solution_best = (parameters.initial_solution != nullptr
+            && parameters.initial_solution->number_of_items() > 0)?
+        local_scheme.solution(*parameters.initial_solution, generator):
+        local_scheme.initial_solution(0, generator);
+    algorithm_formatter.update_solution(
+            local_scheme_to_solution(instance, shared_data.solution_best),
+            "initial solution");
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1;
+            thread_id < parameters.number_of_threads;
+            ++thread_id) {
+        threads.push_back(std::thread(
+                    tabu_search_worker,
+                    std::ref(instance),
+                    std::ref(local_scheme),
+                    std::ref(parameters),
+                    thread_id,
+                    std::ref(shared_data),
+                    std::ref(algorithm_formatter)));
+    }
+    tabu_search_worker(
+            instance,
+            local_scheme,
+            parameters,
+            0,
+            shared_data,
+            algorithm_formatter);
+    for (std::thread& thread: threads)
+        thread.join();
+
+    output.number_of_iterations = shared_data.number_of_iterations;
+    algorithm_formatter.end();
+    return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////// Path relinking /////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/** Pool of elite solutions of the path relinking. */
+struct PathRelinkingPool
+{
+    /** Solutions of the pool. */
+    std::vector<LocalScheme::Solution> solutions;
+
+    /** Global costs of the solutions of the pool. */
+    std::vector<LocalScheme::GlobalCost> global_costs;
+
+    /** Mutex protecting the pool and the algorithm formatter. */
+    std::mutex mutex;
+
+    /** Number of paths started. */
+    std::atomic<Counter> number_of_paths{0};
+
+    /** Number of solutions inserted in the pool. */
+    Counter number_of_pool_updates = 0;
+
+    /** Number of consecutive paths which didn't update the pool. */
+    Counter number_of_paths_without_update = 0;
+};
+
+/**
+ * Insert a solution in the elite pool.
+ *
+ * If the pool is full, the solution replaces the worst solution of the pool
+ * if it is better. A solution already in the pool is not inserted.
+ */
+bool path_relinking_insert(
+        const Instance& instance,
+        const LocalScheme& local_scheme,
+        const PathRelinkingParameters& parameters,
+        const LocalScheme::Solution& solution,
+        const std::string& message,
+        PathRelinkingPool& pool,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    LocalScheme::GlobalCost global_cost = local_scheme.global_cost(solution);
+    std::lock_guard<std::mutex> lock(pool.mutex);
+
+    Counter solution_pos_worst = -1;
+    Counter solution_pos_best = -1;
+    for (Counter solution_pos = 0;
+            solution_pos < (Counter)pool.solutions.size();
+            ++solution_pos) {
+        if (pool.global_costs[solution_pos] == global_cost
+                && pool.solutions[solution_pos].agents == solution.agents) {
+            return false;
+        }
+        if (solution_pos_worst == -1
+                || pool.global_costs[solution_pos_worst] < pool.global_costs[solution_pos]) {
+            solution_pos_worst = solution_pos;
+        }
+        if (solution_pos_best == -1
+                || pool.global_costs[solution_pos] < pool.global_costs[solution_pos_best]) {
+            solution_pos_best = solution_pos;
+        }
+    }
+
+    if ((Counter)pool.solutions.size() < parameters.elite_pool_size) {
+        pool.solutions.push_back(solution);
+        pool.global_costs.push_back(global_cost);
+    } else if (global_cost < pool.global_costs[solution_pos_worst]) {
+        pool.solutions[solution_pos_worst] = solution;
+        pool.global_costs[solution_pos_worst] = global_cost;
+    } else {
+        return false;
+    }
+    pool.number_of_pool_updates++;
+
+    if (solution_pos_best == -1
+            || global_cost < pool.global_costs[solution_pos_best]) {
+        algorithm_formatter.update_solution(
+                local_scheme_to_solution(instance, solution),
+                message);
+    }
+    return true;
+}
+
+/**
+ * Walk from 'solution' toward 'solution_guide'.
+ *
+ * At each step, the item whose reassignment to its agent in 'solution_guide'
+ * leads to the best global cost is reassigned. The local search is run from
+ * evenly spaced intermediate solutions and the solutions obtained are
+ * inserted in the pool.
+ *
+ * Return 'true' if the pool has been updated.
+ */
+bool path_relinking_path(
+        const Instance& instance,
+        LocalScheme& local_scheme,
+        const PathRelinkingParameters& parameters,
+        LocalScheme::Solution solution,
+        const LocalScheme::Solution& solution_guide,
+        std::mt19937_64& generator,
+        const std::string& message,
+        PathRelinkingPool& pool,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    using GlobalCost = LocalScheme::GlobalCost;
+
+    std::vector<ItemIdx> differing_items;
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        if (solution.agents[item_id] != solution_guide.agents[item_id])
+            differing_items.push_back(item_id);
+    }
+    // The local search is run after the steps
+    // 'k * number_of_steps / (number_of_local_searches_per_path + 1)'; the
+    // two ends of the path are already local optima.
+    ItemPos number_of_steps = differing_items.size();
+    Counter number_of_local_searches = (std::min)(
+            parameters.number_of_local_searches_per_path,
+            (Counter)number_of_steps - 1);
+    Counter local_search_id = 1;
+
+    bool updated = false;
+    for (ItemPos step = 1; step < number_of_steps; ++step) {
+        if (parameters.timer.needs_to_end())
+            break;
+
+        // Find the best item to reassign.
+        ItemPos item_pos_best = -1;
+        GlobalCost c_best = worst<GlobalCost>();
+        for (ItemPos item_pos = 0;
+                item_pos < (ItemPos)differing_items.size();
+                ++item_pos) {
+            ItemIdx item_id = differing_items[item_pos];
+            AgentIdx agent_id_old = solution.agents[item_id];
+            local_scheme.remove(solution, item_id);
+            GlobalCost c = local_scheme.cost_add(
+                    solution,
+                    item_id,
+                    solution_guide.agents[item_id]);
+            local_scheme.add(solution, item_id, agent_id_old);
+            if (item_pos_best == -1 || c < c_best) {
+                item_pos_best = item_pos;
+                c_best = c;
+            }
+        }
+
+        // Reassign it.
+        ItemIdx item_id = differing_items[item_pos_best];
+        local_scheme.remove(solution, item_id);
+        local_scheme.add(solution, item_id, solution_guide.agents[item_id]);
+        differing_items[item_pos_best] = differing_items.back();
+        differing_items.pop_back();
+
+        // Run the local search from the intermediate solution.
+        if (local_search_id > number_of_local_searches
+                || step * (number_of_local_searches + 1)
+                < local_search_id * number_of_steps) {
+            continue;
+        }
+        local_search_id++;
+        LocalScheme::Solution solution_tmp = solution;
+        local_scheme.local_search(solution_tmp, generator);
+        if (path_relinking_insert(
+                    instance,
+                    local_scheme,
+                    parameters,
+                    solution_tmp,
+                    message + " step " + std::to_string(step),
+                    pool,
+                    algorithm_formatter)) {
+            updated = true;
+        }
+    }
+    return updated;
+}
+
+void path_relinking_worker(
+        const Instance& instance,
+        LocalScheme& local_scheme,
+        const PathRelinkingParameters& parameters,
+        Counter thread_id,
+        PathRelinkingPool& pool,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    std::mt19937_64 generator(parameters.seed + thread_id);
+    // When the pool hasn't been updated during this number of paths, all
+    // the solutions of the pool but the best one are replaced by new local
+    // optima.
+    Counter maximum_number_of_paths_without_update
+        = parameters.elite_pool_size * (parameters.elite_pool_size - 1);
+
+    for (;;) {
+        if (parameters.timer.needs_to_end())
+            break;
+
+        // Draw the initial and the guiding solutions if the pool is full.
+        // The check and the draw are done in the same critical section since
+        // another thread may restart the pool in between.
+        bool pool_full = false;
+        LocalScheme::Solution solution_initial;
+        LocalScheme::Solution solution_guide;
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if ((Counter)pool.solutions.size() >= parameters.elite_pool_size) {
+                pool_full = true;
+                std::uniform_int_distribution<Counter> d_solution(
+                        0, pool.solutions.size() - 1);
+                Counter solution_pos_1 = d_solution(generator);
+                Counter solution_pos_2 = d_solution(generator);
+                while (solution_pos_2 == solution_pos_1)
+                    solution_pos_2 = d_solution(generator);
+                solution_initial = pool.solutions[solution_pos_1];
+                solution_guide = pool.solutions[solution_pos_2];
+            }
+        }
+
+        // Otherwise, fill the pool with local optima from random solutions.
+        if (!pool_full) {
+            LocalScheme::Solution solution = local_scheme.initial_solution(0, generator);
+            local_scheme.local_search(solution, generator);
+            path_relinking_insert(
+                    instance,
+                    local_scheme,
+                    parameters,
+                    solution,
+                    "thread " + std::to_string(thread_id) + " initial",
+                    pool,
+                    algorithm_formatter);
+            continue;
+        }
+
+        Counter path_id = pool.number_of_paths++;
+        if (parameters.maximum_number_of_paths != -1
+                && path_id >= parameters.maximum_number_of_paths) {
+            pool.number_of_paths--;
+            break;
+        }
+
+        bool updated = path_relinking_path(
+                instance,
+                local_scheme,
+                parameters,
+                solution_initial,
+                solution_guide,
+                generator,
+                "thread " + std::to_string(thread_id)
+                + " path " + std::to_string(path_id),
+                pool,
+                algorithm_formatter);
+
+        // Restart the pool if it stagnates.
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (updated) {
+            pool.number_of_paths_without_update = 0;
+            continue;
+        }
+        pool.number_of_paths_without_update++;
+        if (pool.number_of_paths_without_update < maximum_number_of_paths_without_update)
+            continue;
+        pool.number_of_paths_without_update = 0;
+        Counter solution_pos_best = 0;
+        for (Counter solution_pos = 1;
+                solution_pos < (Counter)pool.solutions.size();
+                ++solution_pos) {
+            if (pool.global_costs[solution_pos] < pool.global_costs[solution_pos_best])
+                solution_pos_best = solution_pos;
+        }
+        pool.solutions = {pool.solutions[solution_pos_best]};
+        pool.global_costs = {pool.global_costs[solution_pos_best]};
+    }
+}
+
+}
+
+const PathRelinkingOutput generalizedassignmentsolver::path_relinking(
+        const Instance& instance,
+        const PathRelinkingParameters& parameters)
+{
+    if (parameters.elite_pool_size < 2) {
+        throw std::invalid_argument(
+                "The elite pool of the path relinking must contain at least "
+                "two solutions.");
+    }
+
+    PathRelinkingOutput output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Path relinking");
+    algorithm_formatter.print_header();
+
+    LocalScheme::Parameters parameters_local_scheme;
+    LocalScheme local_scheme(instance, parameters_local_scheme);
+
+    PathRelinkingPool pool;
+    if (parameters.initial_solution != nullptr
+            && parameters.initial_solution->number_of_items() > 0) {
+        std::mt19937_64 generator(parameters.seed);
+        LocalScheme::Solution solution = local_scheme.solution(
+                *parameters.initial_solution,
+                generator);
+        local_scheme.local_search(solution, generator);
+        path_relinking_insert(
+                instance,
+                local_scheme,
+                parameters,
+                solution,
+                "initial solution",
+                pool,
+                algorithm_formatter);
+    }
+
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1;
+            thread_id < parameters.number_of_threads;
+            ++thread_id) {
+        threads.push_back(std::thread(
+                    path_relinking_worker,
+                    std::ref(instance),
+                    std::ref(local_scheme),
+                    std::ref(parameters),
+                    thread_id,
+                    std::ref(pool),
+                    std::ref(algorithm_formatter)));
+    }
+    path_relinking_worker(
+            instance,
+            local_scheme,
+            parameters,
+            0,
+            pool,
+            algorithm_formatter);
+    for (std::thread& thread: threads)
+        thread.join();
+
+    output.number_of_paths = pool.number_of_paths;
+    output.number_of_pool_updates = pool.number_of_pool_updates;
+    algorithm_formatter.end();
+    return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///////////////////////////// Simulated annealing //////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/** Data shared by the threads of the simulated annealing. */
+struct SimulatedAnnealingSharedData
+{
+    /** Best solution found so far. */
+    LocalScheme::Solution solution_best;
+
+    /**
+     * Mutex protecting 'solution_best', the algorithm formatter and the
+     * synchronization of the replicas.
+     */
+    std::mutex mutex;
+
+    /** Total number of moves. */
+    std::atomic<Counter> number_of_moves{0};
+
+    /** Total number of accepted moves. */
+    std::atomic<Counter> number_of_accepted_moves{0};
+
+    /*
+     * Parallel tempering
+     */
+
+    /** Temperatures of the replicas, from the highest to the lowest. */
+    std::vector<double> temperatures;
+
+    /**
+     * For each temperature, the id of the replica which currently runs at
+     * this temperature.
+     */
+    std::vector<Counter> temperatures_replicas;
+
+    /** For each replica, its current penalized cost. */
+    std::vector<double> replicas_costs;
+
+    /** Number of replicas which have reached the barrier. */
+    Counter number_of_waiting_replicas = 0;
+
+    /** Number of times all the replicas have reached the barrier. */
+    Counter barrier_generation = 0;
+
+    /** Condition variable of the barrier. */
+    std::condition_variable barrier_condition;
+
+    /** Set by the last replica reaching the barrier to stop the search. */
+    bool stop = false;
+
+    /** Number of exchanges between replicas. */
+    Counter number_of_exchanges = 0;
+};
+
+/** State of a simulated annealing run. */
+struct SimulatedAnnealingState
+{
+    /** Current solution. */
+    LocalScheme::Solution solution;
+
+    /** Best solution of the run. */
+    LocalScheme::Solution solution_best;
+
+    /**
+     * 'true' iff the current solution is at least as good as 'solution_best',
+     * in which case 'solution_best' may be outdated.
+     *
+     * The best solution is only copied when the search leaves it.
+     */
+    bool current_is_best = true;
+
+    /** Global cost of the best solution. */
+    LocalScheme::GlobalCost global_cost_best;
+};
+
+inline Weight simulated_annealing_overweight(
+        const Instance& instance,
+        AgentIdx agent_id,
+        Weight weight)
+{
+    return (std::max)((Weight)0, weight - instance.capacity(agent_id));
+}
+
+/**
+ * Run moves at a fixed temperature.
+ *
+ * Return the number of accepted moves.
+ */
+Counter simulated_annealing_run(
+        const Instance& instance,
+        const LocalScheme& local_scheme,
+        const SimulatedAnnealingParameters& parameters,
+        double overweight_penalty,
+        double temperature,
+        Counter number_of_moves,
+        SimulatedAnnealingState& state,
+        std::mt19937_64& generator)
+{
+    LocalScheme::Solution& solution = state.solution;
+    ItemIdx n = instance.number_of_items();
+    AgentIdx m = instance.number_of_agents();
+    std::uniform_int_distribution<ItemIdx> d_item(0, n - 1);
+    std::uniform_int_distribution<AgentIdx> d_agent(0, m - 2);
+    std::uniform_real_distribution<double> d_01(0, 1);
+    Counter number_of_accepted_moves = 0;
+
+    for (Counter move_id = 0; move_id < number_of_moves; ++move_id) {
+        ItemIdx item_id_1 = d_item(generator);
+        AgentIdx agent_id_1 = solution.agents[item_id_1];
+        ItemIdx item_id_2 = -1;
+        AgentIdx agent_id_2 = -1;
+        // Weight differences of the two agents.
+        Weight weight_difference_1 = 0;
+        Weight weight_difference_2 = 0;
+        Cost cost_difference = 0;
+        if (d_01(generator) < parameters.swap_probability) {
+            // Swap move.
+            item_id_2 = d_item(generator);
+            agent_id_2 = solution.agents[item_id_2];
+            if (agent_id_2 == agent_id_1)
+                continue;
+            weight_difference_1
+                = instance.weight(item_id_2, agent_id_1)
+                - instance.weight(item_id_1, agent_id_1);
+            weight_difference_2
+                = instance.weight(item_id_1, agent_id_2)
+                - instance.weight(item_id_2, agent_id_2);
+            cost_difference
+                = instance.cost(item_id_1, agent_id_2)
+                + instance.cost(item_id_2, agent_id_1)
+                - instance.cost(item_id_1, agent_id_1)
+                - instance.cost(item_id_2, agent_id_2);
+        } else {
+            // Shift move.
+            agent_id_2 = d_agent(generator);
+            if (agent_id_2 >= agent_id_1)
+                agent_id_2++;
+            weight_difference_1 = -instance.weight(item_id_1, agent_id_1);
+            weight_difference_2 = instance.weight(item_id_1, agent_id_2);
+            cost_difference
+                = instance.cost(item_id_1, agent_id_2)
+                - instance.cost(item_id_1, agent_id_1);
+        }
+        Weight weight_1 = solution.weights[agent_id_1];
+        Weight weight_2 = solution.weights[agent_id_2];
+        Weight overweight_difference
+            = simulated_annealing_overweight(instance, agent_id_1, weight_1 + weight_difference_1)
+            - simulated_annealing_overweight(instance, agent_id_1, weight_1)
+            + simulated_annealing_overweight(instance, agent_id_2, weight_2 + weight_difference_2)
+            - simulated_annealing_overweight(instance, agent_id_2, weight_2);
+        double difference = cost_difference + overweight_penalty * overweight_difference;
+
+        // Metropolis criterion.
+        if (difference > 0
+                && d_01(generator) >= std::exp(-difference / temperature)) {
+            continue;
+        }
+
+        // Save the best solution before leaving it.
+        LocalScheme::GlobalCost global_cost = {
+            solution.overweight + overweight_difference,
+            solution.cost + cost_difference};
+        if (state.current_is_best && state.global_cost_best < global_cost) {
+            state.solution_best = solution;
+            state.current_is_best = false;
+        }
+
+        // Apply move.
+        number_of_accepted_moves++;
+        local_scheme.remove(solution, item_id_1);
+        if (item_id_2 == -1) {
+            local_scheme.add(solution, item_id_1, agent_id_2);
+        } else {
+            local_scheme.remove(solution, item_id_2);
+            local_scheme.add(solution, item_id_1, agent_id_2);
+            local_scheme.add(solution, item_id_2, agent_id_1);
+        }
+        if (!(state.global_cost_best < global_cost)) {
+            state.global_cost_best = global_cost;
+            state.current_is_best = true;
+        }
+    }
+    return number_of_accepted_moves;
+}
+
+/** Best solution of a run. */
+const LocalScheme::Solution& simulated_annealing_best(
+        const SimulatedAnnealingState& state)
+{
+    return (state.current_is_best)? state.solution: state.solution_best;
+}
+
+/** Update the best solution found so far with the best solution of a run. */
+void simulated_annealing_update_best(
+        const Instance& instance,
+        const LocalScheme& local_scheme,
+        const SimulatedAnnealingState& state,
+        Counter thread_id,
+        SimulatedAnnealingSharedData& shared_data,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    if (!(state.global_cost_best < local_scheme.global_cost(shared_data.solution_best)))
+        return;
+    shared_data.solution_best = simulated_annealing_best(state);
+    algorithm_formatter.update_solution(
+            local_scheme_to_solution(instance, shared_data.solution_best),
+            "thread " + std::to_string(thread_id));
+}
+
+void simulated_annealing_worker(
+        const Instance& instance,
+        const LocalScheme& local_scheme,
+        const SimulatedAnnealingParameters& parameters,
+        double overweight_penalty,
+        double initial_temperature,
+        double final_temperature,
+        Counter number_of_moves_per_temperature,
+        Counter thread_id,
+        SimulatedAnnealingSharedData& shared_data,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    std::mt19937_64 generator(parameters.seed + thread_id);
+    SimulatedAnnealingState state;
+    {
+        std::lock_guard<std::mutex> lock(shared_data.mutex);
+        state.solution = shared_data.solution_best;
+    }
+    state.global_cost_best = local_scheme.global_cost(state.solution);
+
+    // Number of temperature levels between the initial and the final
+    // temperatures. There is at least one level, even if both temperatures
+    // are equal.
+    Counter number_of_temperatures = (std::max)((Counter)1, (Counter)std::ceil(
+            std::log(final_temperature / initial_temperature)
+            / std::log(parameters.cooling_factor)));
+    double temperature = initial_temperature;
+    Counter temperature_id = 0;
+
+    for (;;) {
+        if (parameters.timer.needs_to_end())
+            break;
+        if (parameters.maximum_number_of_moves != -1
+                && shared_data.number_of_moves >= parameters.maximum_number_of_moves) {
+            break;
+        }
+
+        Counter number_of_moves = number_of_moves_per_temperature;
+        if (parameters.maximum_number_of_moves != -1) {
+            number_of_moves = (std::min)(
+                    number_of_moves,
+                    parameters.maximum_number_of_moves - shared_data.number_of_moves);
+            if (number_of_moves <= 0)
+                break;
+        }
+        shared_data.number_of_moves += number_of_moves;
+        shared_data.number_of_accepted_moves += simulated_annealing_run(
+                instance,
+                local_scheme,
+                parameters,
+                overweight_penalty,
+                temperature,
+                number_of_moves,
+                state,
+                generator);
+
+        // Cooling.
+        temperature_id++;
+        if (parameters.cooling_schedule == "linear") {
+            temperature = initial_temperature - (initial_temperature - final_temperature)
+                * temperature_id / number_of_temperatures;
+        } else {
+            temperature *= parameters.cooling_factor;
+        }
+
+        // Reheat and restart from the best solution of the thread.
+        if (temperature_id >= number_of_temperatures) {
+            {
+                std::lock_guard<std::mutex> lock(shared_data.mutex);
+                simulated_annealing_update_best(
+                        instance,
+                        local_scheme,
+                        state,
+                        thread_id,
+                        shared_data,
+                        algorithm_formatter);
+            }
+            if (!state.current_is_best) {
+                state.solution = state.solution_best;
+                state.current_is_best = true;
+            }
+            temperature = initial_temperature;
+            temperature_id = 0;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(shared_data.mutex);
+    simulated_annealing_update_best(
+            instance,
+            local_scheme,
+            state,
+            thread_id,
+            shared_data,
+            algorithm_formatter);
+}
+
+void simulated_annealing_parallel_tempering_worker(
+        const Instance& instance,
+        const LocalScheme& local_scheme,
+        const SimulatedAnnealingParameters& parameters,
+        double overweight_penalty,
+        Counter thread_id,
+        SimulatedAnnealingSharedData& shared_data,
+        AlgorithmFormatter& algorithm_formatter)
+{
+    std::mt19937_64 generator(parameters.seed + thread_id);
+    SimulatedAnnealingState state;
+    {
+        std::lock_guard<std::mutex> lock(shared_data.mutex);
+        state.solution = shared_data.solution_best;
+    }
+    state.global_cost_best = local_scheme.global_cost(state.solution);
+    Counter number_of_replicas = shared_data.temperatures.size();
+
+    for (;;) {
+        // Temperature of the replica.
+        double temperature = 0;
+        {
+            std::lock_guard<std::mutex> lock(shared_data.mutex);
+            for (Counter temperature_id = 0;
+                    temperature_id < number_of_replicas;
+                    ++temperature_id) {
+                if (shared_data.temperatures_replicas[temperature_id] == thread_id)
+                    temperature = shared_data.temperatures[temperature_id];
+            }
+        }
+
+        shared_data.number_of_moves += parameters.exchange_interval;
+        shared_data.number_of_accepted_moves += simulated_annealing_run(
+                instance,
+                local_scheme,
+                parameters,
+                overweight_penalty,
+                temperature,
+                parameters.exchange_interval,
+                state,
+                generator);
+
+        // Barrier. The last replica reaching it exchanges the temperatures
+        // of the replicas and decides whether to stop.
+        std::unique_lock<std::mutex> lock(shared_data.mutex);
+        simulated_annealing_update_best(
+                instance,
+                local_scheme,
+                state,
+                thread_id,
+                shared_data,
+                algorithm_formatter);
+        shared_data.replicas_costs[thread_id]
+            = state.solution.cost + overweight_penalty * state.solution.overweight;
+        Counter barrier_generation = shared_data.barrier_generation;
+        shared_data.number_of_waiting_replicas++;
+        if (shared_data.number_of_waiting_replicas == number_of_replicas) {
+            // Try to exchange the replicas of adjacent temperatures, starting
+            // alternately from the highest and the second highest
+            // temperature.
+            std::uniform_real_distribution<double> d_01(0, 1);
+            for (Counter temperature_id = barrier_generation % 2;
+                    temperature_id + 1 < number_of_replicas;
+                    temperature_id += 2) {
+                Counter replica_id_1 = shared_data.temperatures_replicas[temperature_id];
+                Counter replica_id_2 = shared_data.temperatures_replicas[temperature_id + 1];
+                double delta
+                    = (1.0 / shared_data.temperatures[temperature_id]
+                            - 1.0 / shared_data.temperatures[temperature_id + 1])
+                    * (shared_data.replicas_costs[replica_id_1]
+                            - shared_data.replicas_costs[replica_id_2]);
+                if (delta >= 0 || d_01(generator) < std::exp(delta)) {
+                    std::swap(
+                            shared_data.temperatures_replicas[temperature_id],
+                            shared_data.temperatures_replicas[temperature_id + 1]);
+                    shared_data.number_of_exchanges++;
+                }
+            }
+            shared_data.stop = parameters.timer.needs_to_end()
+                || (parameters.maximum_number_of_moves != -1
+                        && shared_data.number_of_moves >= parameters.maximum_number_of_moves);
+            shared_data.number_of_waiting_replicas = 0;
+            shared_data.barrier_generation++;
+            shared_data.barrier_condition.notify_all();
+        } else {
+            shared_data.barrier_condition.wait(
+                    lock,
+                    [&shared_data, barrier_generation]()
+                    {
+                        return shared_data.barrier_generation != barrier_generation;
+                    });
+        }
+        if (shared_data.stop)
+            break;
+    }
+}
+
+}
+
+const SimulatedAnnealingOutput generalizedassignmentsolver::simulated_annealing(
+        const Instance& instance,
+        const SimulatedAnnealingParameters& parameters)
+{
+    if (parameters.cooling_schedule != "geometric"
+            && parameters.cooling_schedule != "linear") {
+        throw std::invalid_argument(
+                "Unknown cooling schedule \"" + parameters.cooling_schedule + "\".");
+    }
+    if (parameters.cooling_factor <= 0 || parameters.cooling_factor >= 1) {
+        throw std::invalid_argument(
+                "The cooling factor must be in ]0, 1[.");
+    }
+
+    SimulatedAnnealingOutput output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Simulated annealing");
+    algorithm_formatter.print_header();
+
+    LocalScheme::Parameters parameters_local_scheme;
+    LocalScheme local_scheme(instance, parameters_local_scheme);
+
+    SimulatedAnnealingSharedData shared_data;
+    std::mt19937_64 generator(parameters.seed);
+    shared_data.solution_best = (parameters.initial_solution != nullptr
+            && parameters.initial_solution->number_of_items() > 0)?
+        local_scheme.solution(*parameters.initial_solution, generator):
+        local_scheme.initial_solution(0, generator);
+
+    if (instance.number_of_agents() >= 2) {
+        double overweight_penalty = (parameters.overweight_penalty >= 0)?
+            parameters.overweight_penalty:
+            instance.maximum_cost() + 1;
+
+        // Initial temperature.
+        double initial_temperature = parameters.initial_temperature;
+        if (initial_temperature <= 0) {
+            std::uniform_int_distribution<ItemIdx> d_item(0, instance.number_of_items() - 1);
+            std::uniform_int_distribution<AgentIdx> d_agent(0, instance.number_of_agents() - 1);
+            double sum = 0;
+            Counter number_of_samples = 1000;
+            for (Counter sample_id = 0; sample_id < number_of_samples; ++sample_id) {
+                ItemIdx item_id = d_item(generator);
+                sum += std::abs(
+                        instance.cost(item_id, d_agent(generator))
+                        - instance.cost(item_id, d_agent(generator)));
+            }
+            initial_temperature = (std::max)(1.0, sum / number_of_samples);
+        }
+        double final_temperature = (parameters.final_temperature > 0)?
+            (std::min)(parameters.final_temperature, initial_temperature):
+            initial_temperature / 1000;
+        Counter number_of_moves_per_temperature
+            = (parameters.number_of_moves_per_temperature > 0)?
+            parameters.number_of_moves_per_temperature:
+            (Counter)instance.number_of_items() * instance.number_of_agents();
+
+        Counter number_of_threads = (std::max)((Counter)1, parameters.number_of_threads);
+        std::vector<std::thread> threads;
+        if (parameters.parallel_tempering) {
+            for (Counter replica_id = 0;
+                    replica_id < number_of_threads;
+                    ++replica_id) {
+                shared_data.temperatures.push_back((number_of_threads == 1)?
+                        final_temperature:
+                        initial_temperature * std::pow(
+                            final_temperature / initial_temperature,
+                            (double)replica_id / (number_of_threads - 1)));
+                shared_data.temperatures_replicas.push_back(replica_id);
+            }
+            shared_data.replicas_costs.resize(number_of_threads, 0);
+            for (Counter thread_id = 1;
+                    thread_id < number_of_threads;
+                    ++thread_id) {
+                threads.push_back(std::thread(
+                            simulated_annealing_parallel_tempering_worker,
+                            std::ref(instance),
+                            std::ref(local_scheme),
+                            std::ref(parameters),
+                            overweight_penalty,
+                            thread_id,
+                            std::ref(shared_data),
+                            std::ref(algorithm_formatter)));
+            }
+            simulated_annealing_parallel_tempering_worker(
+                    instance,
+                    local_scheme,
+                    parameters,
+                    overweight_penalty,
+                    0,
+                    shared_data,
+                    algorithm_formatter);
+        } else {
+            for (Counter thread_id = 1;
+                    thread_id < number_of_threads;
+                    ++thread_id) {
+                threads.push_back(std::thread(
+                            simulated_annealing_worker,
+                            std::ref(instance),
+                            std::ref(local_scheme),
+                            std::ref(parameters),
+                            overweight_penalty,
+                            initial_temperature,
+                            final_temperature,
+                            number_of_moves_per_temperature,
+                            thread_id,
+                            std::ref(shared_data),
+                            std::ref(algorithm_formatter)));
+            }
+            simulated_annealing_worker(
+                    instance,
+                    local_scheme,
+                    parameters,
+                    overweight_penalty,
+                    initial_temperature,
+                    final_temperature,
+                    number_of_moves_per_temperature,
+                    0,
+                    shared_data,
+                    algorithm_formatter);
+        }
+        for (std::thread& thread: threads)
+            thread.join();
+    }
+    algorithm_formatter.update_solution(
+            local_scheme_to_solution(instance, shared_data.solution_best),
+            "");
 
+    output.number_of_moves = shared_data.number_of_moves;
+    output.number_of_accepted_moves = shared_data.number_of_accepted_moves;
+    output.number_of_exchanges = shared_data.number_of_exchanges;
     algorithm_formatter.end();
     return output;
 }
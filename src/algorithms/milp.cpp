@@ -22,12 +22,35 @@ struct Model
     /** Model. */
     mathoptsolverscmake::MathOptModel model;
 
-    /** x_{i, j} = 1 iff job j is assigned to agent i. */
+    /**
+     * x_{i, j} = 1 iff job j is assigned to agent i.
+     *
+     * '-1' if job j is fixed or if its weight exceeds the capacity of agent
+     * i.
+     */
     std::vector<std::vector<int>> x;
+
+    /**
+     * Reduced cost fixing; if not 'nullptr', the model is built on its
+     * restricted instance.
+     */
+    const ReducedCostFixingOutput* reduced_cost_fixing = nullptr;
 };
 
+/**
+ * Create the MILP model.
+ *
+ * If 'partial_solution' is not 'nullptr', the items it assigns are fixed:
+ * the model only contains the variables of its unassigned items and the
+ * capacities of the agents are reduced accordingly.
+ *
+ * No variable is created for the alternatives whose weight exceeds the
+ * capacity of their agent, in particular for the alternatives removed by
+ * reduced cost fixing.
+ */
 Model create_milp_model(
-        const Instance& instance)
+        const Instance& instance,
+        const Solution* partial_solution = nullptr)
 {
     Model model;
 
@@ -42,10 +65,19 @@ Model create_milp_model(
     for (AgentIdx agent_id = 0;
             agent_id < instance.number_of_agents();
             ++agent_id) {
-        model.x[agent_id] = std::vector<int>(instance.number_of_items());
+        model.x[agent_id] = std::vector<int>(instance.number_of_items(), -1);
         for (ItemIdx item_id = 0;
                 item_id < instance.number_of_items();
                 ++item_id) {
+            if (partial_solution != nullptr
+                    && partial_solution->agent(item_id) != -1) {
+                continue;
+            }
+            Weight capacity = (partial_solution == nullptr)?
+                instance.capacity(agent_id):
+                partial_solution->remaining_capacity(agent_id);
+            if (instance.weight(item_id, agent_id) > capacity)
+                continue;
             model.x[agent_id][item_id] = model.model.variables_lower_bounds.size();
             model.model.variables_lower_bounds.push_back(0);
             model.model.variables_upper_bounds.push_back(1);
@@ -63,9 +95,15 @@ Model create_milp_model(
     for (ItemIdx item_id = 0;
             item_id < instance.number_of_items();
             ++item_id) {
+        if (partial_solution != nullptr
+                && partial_solution->agent(item_id) != -1) {
+            continue;
+        }
         model.model.constraints_starts.push_back(model.model.elements_variables.size());
         // Add row elements
         for (AgentIdx agent_id = 0; agent_id < instance.number_of_agents(); ++agent_id) {
+            if (model.x[agent_id][item_id] == -1)
+                continue;
             model.model.elements_variables.push_back(model.x[agent_id][item_id]);
             model.model.elements_coefficients.push_back(1.0);
         }
@@ -81,36 +119,77 @@ Model create_milp_model(
         for (ItemIdx item_id = 0;
                 item_id < instance.number_of_items();
                 ++item_id) {
+            if (model.x[agent_id][item_id] == -1)
+                continue;
             model.model.elements_variables.push_back(model.x[agent_id][item_id]);
             model.model.elements_coefficients.push_back(instance.weight(item_id, agent_id));
         }
         // Add row bounds
+        Weight capacity = (partial_solution == nullptr)?
+            instance.capacity(agent_id):
+            partial_solution->remaining_capacity(agent_id);
         model.model.constraints_lower_bounds.push_back(-std::numeric_limits<double>::infinity());
-        model.model.constraints_upper_bounds.push_back(instance.capacity(agent_id));
+        model.model.constraints_upper_bounds.push_back(capacity);
     }
 
     return model;
 }
 
+/**
+ * Retrieve a solution of the original instance from a solution of the
+ * model.
+ */
 Solution retrieve_solution(
         const Instance& instance,
         const Model& model,
-        const std::vector<double>& milp_solution)
+        const std::vector<double>& milp_solution,
+        const Solution* partial_solution = nullptr)
 {
-    Solution solution(instance);
+    const Instance& model_instance = (model.reduced_cost_fixing != nullptr)?
+        model.reduced_cost_fixing->instance:
+        instance;
+    Solution solution = (partial_solution == nullptr)?
+        Solution(model_instance):
+        *partial_solution;
     for (ItemIdx item_id = 0;
-            item_id < instance.number_of_items();
+            item_id < model_instance.number_of_items();
             ++item_id) {
         for (AgentIdx agent_id = 0;
-                agent_id < instance.number_of_agents();
+                agent_id < model_instance.number_of_agents();
                 ++agent_id) {
+            if (model.x[agent_id][item_id] == -1)
+                continue;
             if (std::round(milp_solution[model.x[agent_id][item_id]]) == 1)
                 solution.set(item_id, agent_id);
         }
     }
+    if (model.reduced_cost_fixing != nullptr)
+        return model.reduced_cost_fixing->solution(solution);
     return solution;
 }
 
+#if defined(CBC_FOUND) || defined(HIGHS_FOUND)
+/** Retrieve a value of the original instance from a value of the model. */
+double retrieve_value(
+        const Model& model,
+        double milp_value)
+{
+    if (model.reduced_cost_fixing != nullptr)
+        return milp_value + model.reduced_cost_fixing->fixed_cost;
+    return milp_value;
+}
+#endif
+
+/** Retrieve a bound of the original instance from a bound of the model. */
+Cost retrieve_bound(
+        const Model& model,
+        Cost milp_bound)
+{
+    if (model.reduced_cost_fixing != nullptr)
+        return model.reduced_cost_fixing->bound(milp_bound);
+    return milp_bound;
+}
+
 #ifdef CBC_FOUND
 
 class EventHandler: public CbcEventHandler
@@ -167,7 +246,7 @@ CbcEventHandler::CbcAction EventHandler::event(CbcEvent which_event)
     // Retrieve solution.
     double milp_objective_value = mathoptsolverscmake::get_solution_value(cbc_model);
     if (!output_.solution.feasible()
-            || output_.solution.cost() > milp_objective_value) {
+            || output_.solution.cost() > retrieve_value(milp_model_, milp_objective_value)) {
         std::vector<double> milp_solution = mathoptsolverscmake::get_solution(cbc_model);
         Solution solution = retrieve_solution(instance_, milp_model_, milp_solution);
         algorithm_formatter_.update_solution(solution, "node " + std::to_string(number_of_nodes));
@@ -175,7 +254,7 @@ CbcEventHandler::CbcAction EventHandler::event(CbcEvent which_event)
 
     // Retrieve bound.
     Cost bound = std::ceil(mathoptsolverscmake::get_bound(cbc_model) - 1e5);
-    algorithm_formatter_.update_bound(bound, "node " + std::to_string(number_of_nodes));
+    algorithm_formatter_.update_bound(retrieve_bound(milp_model_, bound), "node " + std::to_string(number_of_nodes));
 
     // Check end.
     if (parameters_.timer.needs_to_end())
@@ -240,7 +319,30 @@ MilpOutput generalizedassignmentsolver::milp(
 
     algorithm_formatter.print_header();
 
-    Model milp_model = create_milp_model(instance);
+    if (initial_solution != nullptr)
+        algorithm_formatter.update_solution(*initial_solution, "initial solution");
+
+    // Reduced cost fixing.
+    const ReducedCostFixingOutput* reduced_cost_fixing = parameters.reduced_cost_fixing;
+    if (reduced_cost_fixing != nullptr) {
+        if (&reduced_cost_fixing->original_instance != &instance) {
+            throw std::invalid_argument(
+                    "generalizedassignmentsolver::milp: "
+                    "reduced cost fixing of another instance.");
+        }
+        algorithm_formatter.update_bound(
+                std::ceil(reduced_cost_fixing->lagrangian_bound - 1e-5),
+                "reduced cost fixing");
+        if (reduced_cost_fixing->no_better_solution) {
+            algorithm_formatter.update_bound(reduced_cost_fixing->upper_bound, "reduced cost fixing");
+            algorithm_formatter.end();
+            return output;
+        }
+    }
+
+    Model milp_model = create_milp_model(
+            (reduced_cost_fixing != nullptr)? reduced_cost_fixing->instance: instance);
+    milp_model.reduced_cost_fixing = reduced_cost_fixing;
 
     std::vector<double> milp_solution;
     double milp_bound = 0;
@@ -284,7 +386,7 @@ MilpOutput generalizedassignmentsolver::milp(
                         // Retrieve solution.
                         double milp_objective_value = highs_output->mip_primal_bound;
                         if (!output.solution.feasible()
-                                || output.solution.cost() > milp_objective_value) {
+                                || output.solution.cost() > retrieve_value(milp_model, milp_objective_value)) {
                             Solution solution = retrieve_solution(instance, milp_model, highs_output->mip_solution);
                             algorithm_formatter.update_solution(solution, "node " + std::to_string(highs_output->mip_node_count));
                         }
@@ -292,7 +394,7 @@ MilpOutput generalizedassignmentsolver::milp(
                         // Retrieve bound.
                         Cost bound = std::ceil(highs_output->mip_dual_bound - 1e-5);
                         if (bound != std::numeric_limits<double>::infinity())
-                            algorithm_formatter.update_bound(bound, "node " + std::to_string(highs_output->mip_node_count));
+                            algorithm_formatter.update_bound(retrieve_bound(milp_model, bound), "node " + std::to_string(highs_output->mip_node_count));
                     }
 
                     // Check end.
@@ -333,12 +435,65 @@ MilpOutput generalizedassignmentsolver::milp(
     }
 
     // Retrieve solution.
-    Solution solution = retrieve_solution(instance, milp_model, milp_solution);
-    algorithm_formatter.update_solution(solution, "");
+    if ((int)milp_solution.size() == milp_model.model.number_of_variables()) {
+        Solution solution = retrieve_solution(instance, milp_model, milp_solution);
+        algorithm_formatter.update_solution(solution, "");
+    }
 
     // Retrieve bound.
-    algorithm_formatter.update_bound(milp_bound, "");
+    algorithm_formatter.update_bound(retrieve_bound(milp_model, milp_bound), "");
 
     algorithm_formatter.end();
     return output;
 }
+
+Solution generalizedassignmentsolver::milp_repair(
+        const Solution& partial_solution,
+        const MilpParameters& parameters)
+{
+    const Instance& instance = partial_solution.instance();
+    Model milp_model = create_milp_model(instance, &partial_solution);
+    if (milp_model.model.number_of_variables() == 0)
+        return partial_solution;
+
+    std::vector<double> milp_solution;
+
+    if (parameters.solver == mathoptsolverscmake::SolverName::Cbc) {
+#ifdef CBC_FOUND
+        OsiCbcSolverInterface osi_solver;
+        CbcModel cbc_model(osi_solver);
+        mathoptsolverscmake::reduce_printout(cbc_model);
+        mathoptsolverscmake::set_time_limit(cbc_model, parameters.timer.remaining_time());
+        mathoptsolverscmake::load(cbc_model, milp_model.model);
+        mathoptsolverscmake::solve(cbc_model);
+        milp_solution = mathoptsolverscmake::get_solution(cbc_model);
+#else
+        throw std::invalid_argument("");
+#endif
+
+    } else if (parameters.solver == mathoptsolverscmake::SolverName::Highs) {
+#ifdef HIGHS_FOUND
+        Highs highs;
+        mathoptsolverscmake::reduce_printout(highs);
+        mathoptsolverscmake::set_time_limit(highs, parameters.timer.remaining_time());
+        mathoptsolverscmake::load(highs, milp_model.model);
+        mathoptsolverscmake::solve(highs);
+        milp_solution = mathoptsolverscmake::get_solution(highs);
+#else
+        throw std::invalid_argument("");
+#endif
+
+    } else {
+        throw std::invalid_argument("");
+    }
+
+    // No solution found within the time limit.
+    if ((int)milp_solution.size() != milp_model.model.number_of_variables())
+        return partial_solution;
+
+    return retrieve_solution(
+            instance,
+            milp_model,
+            milp_solution,
+            &partial_solution);
+}
@@ -0,0 +1,191 @@
+#include "generalizedassignmentsolver/algorithms/reduced_cost_fixing.hpp"
+
+#include "generalizedassignmentsolver/instance_builder.hpp"
+
+#include <limits>
+
+using namespace generalizedassignmentsolver;
+
+Solution ReducedCostFixingOutput::solution(
+        const Solution& restricted_solution) const
+{
+    Solution solution(original_instance);
+    for (ItemIdx item_id = 0;
+            item_id < original_instance.number_of_items();
+            ++item_id) {
+        if (fixed_items_agents[item_id] != -1)
+            solution.set(item_id, fixed_items_agents[item_id]);
+    }
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        AgentIdx agent_id = restricted_solution.agent(item_id);
+        if (agent_id != -1)
+            solution.set(original_item_ids[item_id], agent_id);
+    }
+    return solution;
+}
+
+Cost ReducedCostFixingOutput::bound(
+        Cost restricted_bound) const
+{
+    // Every solution strictly better than the upper bound is a solution of
+    // the restricted instance.
+    if (no_better_solution)
+        return upper_bound;
+    return (std::min)(upper_bound, restricted_bound + fixed_cost);
+}
+
+Solution ReducedCostFixingOutput::restricted_solution(
+        const Solution& solution) const
+{
+    Solution restricted_solution(instance);
+    for (ItemIdx item_id = 0;
+            item_id < original_instance.number_of_items();
+            ++item_id) {
+        if (fixed_items_agents[item_id] != -1
+                && fixed_items_agents[item_id] != solution.agent(item_id)) {
+            return Solution(instance);
+        }
+    }
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        AgentIdx agent_id = solution.agent(original_item_ids[item_id]);
+        if (agent_id != -1)
+            restricted_solution.set(item_id, agent_id);
+    }
+    return restricted_solution;
+}
+
+std::vector<double> ReducedCostFixingOutput::restricted_duals(
+        const std::vector<double>& duals) const
+{
+    AgentIdx m = instance.number_of_agents();
+    std::vector<double> restricted_duals(duals.begin(), duals.begin() + m);
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        restricted_duals.push_back(duals[m + original_item_ids[item_id]]);
+    }
+    return restricted_duals;
+}
+
+nlohmann::json ReducedCostFixingOutput::to_json() const
+{
+    return nlohmann::json {
+        {"UpperBound", upper_bound},
+        {"LagrangianBound", lagrangian_bound},
+        {"NumberOfRemovedAlternatives", number_of_removed_alternatives},
+        {"NumberOfFixedItems", number_of_fixed_items},
+        {"NoBetterSolution", no_better_solution},
+    };
+}
+
+ReducedCostFixingOutput generalizedassignmentsolver::reduced_cost_fixing(
+        const Instance& instance,
+        const std::vector<double>& multipliers,
+        Cost upper_bound)
+{
+    ItemIdx n = instance.number_of_items();
+    AgentIdx m = instance.number_of_agents();
+    if ((AgentIdx)multipliers.size() != m) {
+        throw std::invalid_argument(
+                "generalizedassignmentsolver::reduced_cost_fixing: "
+                "wrong number of multipliers.");
+    }
+
+    // Compute the value of the Lagrangian dual function.
+    std::vector<double> items_minimum_reduced_costs(n, std::numeric_limits<double>::infinity());
+    double lagrangian_bound = 0;
+    for (AgentIdx agent_id = 0; agent_id < m; ++agent_id)
+        lagrangian_bound -= (std::max)(0.0, multipliers[agent_id]) * instance.capacity(agent_id);
+    for (ItemIdx item_id = 0; item_id < n; ++item_id) {
+        for (AgentIdx agent_id = 0; agent_id < m; ++agent_id) {
+            double reduced_cost = instance.cost(item_id, agent_id)
+                + (std::max)(0.0, multipliers[agent_id]) * instance.weight(item_id, agent_id);
+            items_minimum_reduced_costs[item_id] = (std::min)(
+                    items_minimum_reduced_costs[item_id],
+                    reduced_cost);
+        }
+        lagrangian_bound += items_minimum_reduced_costs[item_id];
+    }
+
+    // Remove the alternatives. Since the costs are integers, a solution
+    // strictly better than the upper bound has a value of at most
+    // 'upper_bound - 1'.
+    double threshold = (double)(upper_bound - 1) - lagrangian_bound + 1e-6;
+    std::vector<std::vector<bool>> removed(n, std::vector<bool>(m, false));
+    std::vector<AgentIdx> fixed_items_agents(n, -1);
+    std::vector<Weight> capacities(m);
+    for (AgentIdx agent_id = 0; agent_id < m; ++agent_id)
+        capacities[agent_id] = instance.capacity(agent_id);
+    Counter number_of_removed_alternatives = 0;
+    ItemIdx number_of_fixed_items = 0;
+    Cost fixed_cost = 0;
+    bool no_better_solution = false;
+    std::vector<ItemIdx> original_item_ids;
+    for (ItemIdx item_id = 0; item_id < n; ++item_id) {
+        AgentIdx number_of_alternatives = 0;
+        AgentIdx agent_id_last = -1;
+        for (AgentIdx agent_id = 0; agent_id < m; ++agent_id) {
+            double reduced_cost = instance.cost(item_id, agent_id)
+                + (std::max)(0.0, multipliers[agent_id]) * instance.weight(item_id, agent_id);
+            if (instance.weight(item_id, agent_id) > instance.capacity(agent_id)
+                    || reduced_cost - items_minimum_reduced_costs[item_id] > threshold) {
+                removed[item_id][agent_id] = true;
+                number_of_removed_alternatives++;
+            } else {
+                number_of_alternatives++;
+                agent_id_last = agent_id;
+            }
+        }
+        if (number_of_alternatives == 0) {
+            no_better_solution = true;
+        } else if (number_of_alternatives == 1) {
+            fixed_items_agents[item_id] = agent_id_last;
+            capacities[agent_id_last] -= instance.weight(item_id, agent_id_last);
+            fixed_cost += instance.cost(item_id, agent_id_last);
+            number_of_fixed_items++;
+        } else {
+            original_item_ids.push_back(item_id);
+        }
+    }
+    for (AgentIdx agent_id = 0; agent_id < m; ++agent_id)
+        if (capacities[agent_id] < 0)
+            no_better_solution = true;
+
+    // Build the restricted instance.
+    InstanceBuilder instance_builder;
+    instance_builder.add_agents(m);
+    for (AgentIdx agent_id = 0; agent_id < m; ++agent_id)
+        instance_builder.set_capacity(agent_id, (std::max)((Weight)0, capacities[agent_id]));
+    instance_builder.add_items(original_item_ids.size());
+    for (ItemIdx item_id = 0;
+            item_id < (ItemIdx)original_item_ids.size();
+            ++item_id) {
+        ItemIdx original_item_id = original_item_ids[item_id];
+        for (AgentIdx agent_id = 0; agent_id < m; ++agent_id) {
+            Weight weight = instance.weight(original_item_id, agent_id);
+            if (removed[original_item_id][agent_id]) {
+                weight = (std::max)((Weight)0, capacities[agent_id]) + 1;
+            }
+            instance_builder.set_weight(item_id, agent_id, weight);
+            instance_builder.set_cost(
+                    item_id,
+                    agent_id,
+                    instance.cost(original_item_id, agent_id));
+        }
+    }
+
+    ReducedCostFixingOutput output(instance, instance_builder.build());
+    output.upper_bound = upper_bound;
+    output.lagrangian_bound = lagrangian_bound;
+    output.original_item_ids = original_item_ids;
+    output.fixed_items_agents = fixed_items_agents;
+    output.fixed_cost = fixed_cost;
+    output.number_of_removed_alternatives = number_of_removed_alternatives;
+    output.number_of_fixed_items = number_of_fixed_items;
+    output.no_better_solution = no_better_solution;
+    return output;
+}
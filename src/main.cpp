@@ -1,10 +1,13 @@
 #include "generalizedassignmentsolver/instance_builder.hpp"
+#include "generalizedassignmentsolver/warm_start_cache.hpp"
 
 #include "generalizedassignmentsolver/algorithms/column_generation.hpp"
 #include "generalizedassignmentsolver/algorithms/milp.hpp"
+#include "generalizedassignmentsolver/algorithms/reduced_cost_fixing.hpp"
 #include "generalizedassignmentsolver/algorithms/lagrangian_relaxation.hpp"
 #include "generalizedassignmentsolver/algorithms/greedy.hpp"
 #include "generalizedassignmentsolver/algorithms/local_search.hpp"
+#include "generalizedassignmentsolver/algorithms/large_neighborhood_search.hpp"
 
 #include <boost/program_options.hpp>
 
@@ -41,12 +44,52 @@ void read_args(
     }
 }
 
+/**
+ * Run reduced cost fixing with the multipliers of the Lagrangian relaxation
+ * of the knapsack constraints.
+ *
+ * The upper bound is the value of the best of the initial solution and of
+ * the solutions of the Lagrangian heuristic; this solution is written to
+ * 'incumbent'. Return 'nullptr' if none of them is feasible.
+ */
+std::unique_ptr<ReducedCostFixingOutput> run_reduced_cost_fixing(
+        const Instance& instance,
+        const Solution& initial_solution,
+        const Parameters& parameters,
+        Solution& incumbent)
+{
+    LagrangianRelaxationKnapsackParameters lr_parameters;
+    lr_parameters.verbosity_level = 0;
+    lr_parameters.timer = parameters.timer;
+    lr_parameters.lagrangian_heuristic = true;
+    auto lr_output = lagrangian_relaxation_knapsack(instance, nullptr, nullptr, lr_parameters);
+
+    incumbent = lr_output.solution;
+    if (initial_solution.feasible()
+            && (!incumbent.feasible()
+                || initial_solution.cost() < incumbent.cost())) {
+        incumbent = initial_solution;
+    }
+    if (!incumbent.feasible())
+        return nullptr;
+    return std::unique_ptr<ReducedCostFixingOutput>(
+            new ReducedCostFixingOutput(reduced_cost_fixing(
+                    instance,
+                    lr_output.multipliers,
+                    incumbent.cost())));
+}
+
 Output run(
         const Instance& instance,
-        const po::variables_map& vm)
+        const po::variables_map& vm,
+        WarmStart& warm_start)
 {
     std::mt19937_64 generator(vm["seed"].as<Seed>());
     Solution initial_solution(instance, vm["initial-solution"].as<std::string>());
+    if (vm["initial-solution"].as<std::string>().empty()
+            && warm_start.solution(instance).feasible()) {
+        initial_solution = warm_start.solution(instance);
+    }
 
     // Run algorithm.
     std::string algorithm = vm["algorithm"].as<std::string>();
@@ -74,6 +117,44 @@ Output run(
         if (vm.count("desirability"))
             parameters.desirability = vm["desirability"].as<std::string>();
         return mthg_regret(instance, parameters);
+    } else if (algorithm == "greedy-repair") {
+        GreedyParameters parameters;
+        read_args(parameters, vm);
+        if (vm.count("desirability"))
+            parameters.desirability = vm["desirability"].as<std::string>();
+        // The initial solution is a solution of the previous instance.
+        if (!vm.count("previous-instance"))
+            return greedy_repair(instance, initial_solution, parameters);
+        InstanceBuilder previous_instance_builder;
+        previous_instance_builder.read(
+                vm["previous-instance"].as<std::string>(),
+                vm["format"].as<std::string>());
+        const Instance previous_instance = previous_instance_builder.build();
+        Solution previous_solution(
+                previous_instance,
+                vm["initial-solution"].as<std::string>());
+        return greedy_repair(instance, previous_solution, parameters);
+    } else if (algorithm == "greedy-portfolio") {
+        GreedyPortfolioParameters parameters;
+        read_args(parameters, vm);
+        if (vm.count("threads"))
+            parameters.number_of_threads = vm["threads"].as<Counter>();
+        return greedy_portfolio(instance, parameters);
+    } else if (algorithm == "grasp") {
+        GraspParameters parameters;
+        read_args(parameters, vm);
+        if (vm.count("desirability"))
+            parameters.desirability = vm["desirability"].as<std::string>();
+        if (vm.count("construction"))
+            parameters.construction = vm["construction"].as<std::string>();
+        if (vm.count("restricted-candidate-list-size"))
+            parameters.restricted_candidate_list_size = vm["restricted-candidate-list-size"].as<Counter>();
+        if (vm.count("maximum-number-of-iterations"))
+            parameters.maximum_number_of_iterations = vm["maximum-number-of-iterations"].as<Counter>();
+        if (vm.count("threads"))
+            parameters.number_of_threads = vm["threads"].as<Counter>();
+        parameters.seed = vm["seed"].as<Seed>();
+        return grasp(instance, parameters);
 
     } else if (algorithm == "milp") {
 #ifdef XPRESS_FOUND
@@ -83,7 +164,23 @@ Output run(
         read_args(parameters, vm);
         if (vm.count("solver"))
             parameters.solver = vm["solver"].as<mathoptsolverscmake::SolverName>();
-        auto output = milp(instance, nullptr, parameters);
+        Solution incumbent(instance);
+        std::unique_ptr<ReducedCostFixingOutput> reduced_cost_fixing_output;
+        if (vm.count("reduced-cost-fixing")) {
+            reduced_cost_fixing_output = run_reduced_cost_fixing(
+                    instance,
+                    initial_solution,
+                    parameters,
+                    incumbent);
+            parameters.reduced_cost_fixing = reduced_cost_fixing_output.get();
+        }
+        const Solution* milp_initial_solution = nullptr;
+        if (reduced_cost_fixing_output != nullptr) {
+            milp_initial_solution = &incumbent;
+        } else if (initial_solution.feasible()) {
+            milp_initial_solution = &initial_solution;
+        }
+        auto output = milp(instance, milp_initial_solution, parameters);
 #ifdef XPRESS_FOUND
         XPRSfree();
 #endif
@@ -94,7 +191,31 @@ Output run(
         read_args(parameters, vm);
         if (vm.count("linear-programming-solver"))
             parameters.linear_programming_solver = vm["linear-programming-solver"].as<std::string>();
-        return column_generation(instance, parameters);
+        Solution incumbent(instance);
+        std::unique_ptr<ReducedCostFixingOutput> reduced_cost_fixing_output;
+        if (vm.count("reduced-cost-fixing")) {
+            reduced_cost_fixing_output = run_reduced_cost_fixing(
+                    instance,
+                    initial_solution,
+                    parameters,
+                    incumbent);
+            parameters.reduced_cost_fixing = reduced_cost_fixing_output.get();
+        }
+        if (reduced_cost_fixing_output != nullptr) {
+            parameters.initial_solution = &incumbent;
+        } else if (initial_solution.feasible()) {
+            parameters.initial_solution = &initial_solution;
+        }
+        if (!warm_start.column_generation_duals.empty())
+            parameters.initial_duals = &warm_start.column_generation_duals;
+        auto output = column_generation(instance, parameters);
+        // With reduced cost fixing, the duals are those of the restricted
+        // instance; they are only kept if no item has been fixed.
+        if ((ItemIdx)output.dual_solution.size()
+                == instance.number_of_agents() + instance.number_of_items()) {
+            warm_start.column_generation_duals = output.dual_solution;
+        }
+        return output;
     } else if (algorithm == "column-generation-heuristic-greedy") {
         ColumnGenerationParameters parameters;
         read_args(parameters, vm);
@@ -111,24 +232,122 @@ Output run(
     } else if (algorithm == "lagrangian-relaxation-assignment") {
         LagrangianRelaxationAssignmentParameters parameters;
         read_args(parameters, vm);
-        if (vm.count("solver"))
+        if (vm.count("threads"))
+            parameters.number_of_threads = vm["threads"].as<Counter>();
+        if (vm.count("solver")) {
             parameters.solver = vm["solver"].as<mathoptsolverscmake::SolverName>();
-        return lagrangian_relaxation_assignment(instance, nullptr, nullptr, parameters);
+            parameters.dual_optimizer = "solver";
+        }
+        if (vm.count("dual-optimizer"))
+            parameters.dual_optimizer = vm["dual-optimizer"].as<std::string>();
+        if (vm.count("maximum-number-of-iterations"))
+            parameters.maximum_number_of_iterations = vm["maximum-number-of-iterations"].as<Counter>();
+        parameters.lagrangian_heuristic = vm.count("lagrangian-heuristic");
+        std::vector<double>* initial_multipliers
+            = (!warm_start.lagrangian_relaxation_assignment_multipliers.empty())?
+            &warm_start.lagrangian_relaxation_assignment_multipliers: nullptr;
+        auto output = lagrangian_relaxation_assignment(instance, initial_multipliers, nullptr, parameters);
+        if ((ItemIdx)output.multipliers.size() == instance.number_of_items())
+            warm_start.lagrangian_relaxation_assignment_multipliers = output.multipliers;
+        return output;
     } else if (algorithm == "lagrangian-relaxation-knapsack") {
         LagrangianRelaxationKnapsackParameters parameters;
         read_args(parameters, vm);
-        if (vm.count("solver"))
+        if (vm.count("threads"))
+            parameters.number_of_threads = vm["threads"].as<Counter>();
+        if (vm.count("solver")) {
             parameters.solver = vm["solver"].as<mathoptsolverscmake::SolverName>();
-        return lagrangian_relaxation_knapsack(instance, nullptr, nullptr, parameters);
+            parameters.dual_optimizer = "solver";
+        }
+        if (vm.count("dual-optimizer"))
+            parameters.dual_optimizer = vm["dual-optimizer"].as<std::string>();
+        if (vm.count("maximum-number-of-iterations"))
+            parameters.maximum_number_of_iterations = vm["maximum-number-of-iterations"].as<Counter>();
+        parameters.lagrangian_heuristic = vm.count("lagrangian-heuristic");
+        std::vector<double>* initial_multipliers
+            = (!warm_start.lagrangian_relaxation_knapsack_multipliers.empty())?
+            &warm_start.lagrangian_relaxation_knapsack_multipliers: nullptr;
+        auto output = lagrangian_relaxation_knapsack(instance, initial_multipliers, nullptr, parameters);
+        if ((AgentIdx)output.multipliers.size() == instance.number_of_agents())
+            warm_start.lagrangian_relaxation_knapsack_multipliers = output.multipliers;
+        return output;
 
     } else if (algorithm == "local-search") {
         LocalSearchParameters parameters;
         read_args(parameters, vm);
+        if (vm.count("threads"))
+            parameters.number_of_threads = vm["threads"].as<Counter>();
         if (vm.count("maximum-number-of-nodes"))
             parameters.maximum_number_of_nodes = vm["maximum-number-of-nodes"].as<Counter>();
+        parameters.adaptive_penalty = vm.count("adaptive-penalty");
+        if (vm.count("variable-depth-search-maximum-depth"))
+            parameters.variable_depth_search_maximum_depth = vm["variable-depth-search-maximum-depth"].as<ItemIdx>();
         parameters.initial_solution = &initial_solution;
         return local_search(instance, generator, parameters);
 
+    } else if (algorithm == "variable-depth-search") {
+        VariableDepthSearchParameters parameters;
+        read_args(parameters, vm);
+        if (vm.count("variable-depth-search-maximum-depth"))
+            parameters.maximum_depth = vm["variable-depth-search-maximum-depth"].as<ItemIdx>();
+        parameters.initial_solution = &initial_solution;
+        return variable_depth_search(instance, generator, parameters);
+
+    } else if (algorithm == "tabu-search") {
+        TabuSearchParameters parameters;
+        read_args(parameters, vm);
+        if (vm.count("threads"))
+            parameters.number_of_threads = vm["threads"].as<Counter>();
+        if (vm.count("maximum-number-of-iterations"))
+            parameters.maximum_number_of_iterations = vm["maximum-number-of-iterations"].as<Counter>();
+        parameters.seed = vm["seed"].as<Seed>();
+        parameters.initial_solution = &initial_solution;
+        return tabu_search(instance, parameters);
+
+    } else if (algorithm == "path-relinking") {
+        PathRelinkingParameters parameters;
+        read_args(parameters, vm);
+        if (vm.count("threads"))
+            parameters.number_of_threads = vm["threads"].as<Counter>();
+        if (vm.count("maximum-number-of-paths"))
+            parameters.maximum_number_of_paths = vm["maximum-number-of-paths"].as<Counter>();
+        if (vm.count("elite-pool-size"))
+            parameters.elite_pool_size = vm["elite-pool-size"].as<Counter>();
+        parameters.seed = vm["seed"].as<Seed>();
+        parameters.initial_solution = &initial_solution;
+        return path_relinking(instance, parameters);
+
+    } else if (algorithm == "simulated-annealing") {
+        SimulatedAnnealingParameters parameters;
+        read_args(parameters, vm);
+        if (vm.count("threads"))
+            parameters.number_of_threads = vm["threads"].as<Counter>();
+        if (vm.count("maximum-number-of-moves"))
+            parameters.maximum_number_of_moves = vm["maximum-number-of-moves"].as<Counter>();
+        if (vm.count("cooling-schedule"))
+            parameters.cooling_schedule = vm["cooling-schedule"].as<std::string>();
+        if (vm.count("cooling-factor"))
+            parameters.cooling_factor = vm["cooling-factor"].as<double>();
+        parameters.parallel_tempering = vm.count("parallel-tempering");
+        parameters.seed = vm["seed"].as<Seed>();
+        parameters.initial_solution = &initial_solution;
+        return simulated_annealing(instance, parameters);
+
+    } else if (algorithm == "large-neighborhood-search") {
+        LargeNeighborhoodSearchParameters parameters;
+        read_args(parameters, vm);
+        if (vm.count("threads"))
+            parameters.number_of_threads = vm["threads"].as<Counter>();
+        if (vm.count("maximum-number-of-iterations"))
+            parameters.maximum_number_of_iterations = vm["maximum-number-of-iterations"].as<Counter>();
+        if (vm.count("solver")) {
+            parameters.milp_repair = true;
+            parameters.solver = vm["solver"].as<mathoptsolverscmake::SolverName>();
+        }
+        parameters.seed = vm["seed"].as<Seed>();
+        parameters.initial_solution = &initial_solution;
+        return large_neighborhood_search(instance, parameters);
+
     } else {
         throw std::invalid_argument(
                 "Unknown algorithm \"" + algorithm + "\".");
@@ -157,8 +376,25 @@ int main(int argc, char *argv[])
 
         ("desirability,", po::value<std::string>(), "set desirability")
         ("maximum-number-of-nodes,", po::value<Counter>(), "set maximum number of nodes")
+        ("maximum-number-of-iterations,", po::value<Counter>(), "set maximum number of iterations")
+        ("construction,", po::value<std::string>(), "set construction algorithm (grasp)")
+        ("previous-instance,", po::value<std::string>(), "set previous instance of the initial solution (greedy-repair)")
+        ("restricted-candidate-list-size,", po::value<Counter>(), "set restricted candidate list size (grasp)")
+        ("adaptive-penalty", "use adaptive penalties for capacity violations (local-search)")
+        ("variable-depth-search-maximum-depth,", po::value<ItemIdx>(), "set maximum depth of the variable-depth search chains (local-search, variable-depth-search)")
+        ("maximum-number-of-paths,", po::value<Counter>(), "set maximum number of paths (path-relinking)")
+        ("elite-pool-size,", po::value<Counter>(), "set elite pool size (path-relinking)")
+        ("maximum-number-of-moves,", po::value<Counter>(), "set maximum number of moves (simulated-annealing)")
+        ("cooling-schedule,", po::value<std::string>(), "set cooling schedule: geometric, linear (simulated-annealing)")
+        ("cooling-factor,", po::value<double>(), "set cooling factor (simulated-annealing)")
+        ("parallel-tempering", "use parallel tempering (simulated-annealing)")
+        ("dual-optimizer,", po::value<std::string>(), "set Lagrangian dual optimizer: subgradient, bundle, solver (lagrangian-relaxation)")
+        ("lagrangian-heuristic", "build primal solutions during the dual iterations (lagrangian-relaxation)")
+        ("reduced-cost-fixing", "remove variables by Lagrangian reduced cost fixing (milp, column-generation)")
+        ("warm-start-cache,", po::value<std::string>(), "set warm start cache directory")
+        ("threads,", po::value<Counter>(), "set number of threads")
         ("linear-programming-solver,", po::value<std::string>(), "set linear programming solver")
-        ("solver,", po::value<mathoptsolverscmake::SolverName>(), "set solver (milp, Lagrangian relaxation)")
+        ("solver,", po::value<mathoptsolverscmake::SolverName>(), "set solver (milp, Lagrangian relaxation, MILP repair of large-neighborhood-search)")
         ;
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -180,8 +416,22 @@ int main(int argc, char *argv[])
             vm["format"].as<std::string>());
     const Instance instance = instance_builder.build();
 
+    // Load warm start.
+    std::unique_ptr<WarmStartCache> warm_start_cache;
+    WarmStart warm_start;
+    if (vm.count("warm-start-cache")) {
+        warm_start_cache.reset(new WarmStartCache(vm["warm-start-cache"].as<std::string>()));
+        warm_start_cache->load(instance, warm_start);
+    }
+
     // Run.
-    Output output = run(instance, vm);
+    Output output = run(instance, vm, warm_start);
+
+    // Save warm start.
+    if (warm_start_cache != nullptr) {
+        warm_start.update_solution(output.solution);
+        warm_start_cache->save(instance, warm_start);
+    }
 
     // Write outputs.
     std::string certificate_path = vm["certificate"].as<std::string>();
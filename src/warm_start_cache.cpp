@@ -0,0 +1,163 @@
+#include "generalizedassignmentsolver/warm_start_cache.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace generalizedassignmentsolver;
+
+namespace
+{
+
+/** Add a value to a FNV-1a hash. */
+void hash_combine(
+        uint64_t& hash,
+        int64_t value)
+{
+    for (int byte = 0; byte < 8; ++byte) {
+        hash ^= (uint64_t)(value >> (8 * byte)) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+}
+
+}
+
+uint64_t generalizedassignmentsolver::content_hash(
+        const Instance& instance)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    hash_combine(hash, instance.number_of_agents());
+    hash_combine(hash, instance.number_of_items());
+    for (AgentIdx agent_id = 0;
+            agent_id < instance.number_of_agents();
+            ++agent_id) {
+        hash_combine(hash, instance.capacity(agent_id));
+    }
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        for (AgentIdx agent_id = 0;
+                agent_id < instance.number_of_agents();
+                ++agent_id) {
+            hash_combine(hash, instance.weight(item_id, agent_id));
+            hash_combine(hash, instance.cost(item_id, agent_id));
+        }
+    }
+    return hash;
+}
+
+Solution WarmStart::solution(
+        const Instance& instance) const
+{
+    Solution solution(instance);
+    if ((ItemIdx)items_agents.size() != instance.number_of_items())
+        return solution;
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        AgentIdx agent_id = items_agents[item_id];
+        if (agent_id >= 0 && agent_id < instance.number_of_agents())
+            solution.set(item_id, agent_id);
+    }
+    return solution;
+}
+
+void WarmStart::update_solution(
+        const Solution& solution)
+{
+    if (!solution.feasible())
+        return;
+    Solution solution_cur = this->solution(solution.instance());
+    if (solution_cur.feasible() && solution_cur.cost() <= solution.cost())
+        return;
+    const Instance& instance = solution.instance();
+    items_agents.resize(instance.number_of_items());
+    for (ItemIdx item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        items_agents[item_id] = solution.agent(item_id);
+    }
+}
+
+std::string WarmStartCache::hash_path(
+        const Instance& instance) const
+{
+    std::stringstream ss;
+    ss << directory_path_ << "/"
+        << std::hex << std::setw(16) << std::setfill('0')
+        << content_hash(instance) << ".json";
+    return ss.str();
+}
+
+std::string WarmStartCache::dimensions_path(
+        const Instance& instance) const
+{
+    return directory_path_ + "/"
+        + std::to_string(instance.number_of_agents()) + "x"
+        + std::to_string(instance.number_of_items()) + ".json";
+}
+
+bool WarmStartCache::load(
+        const Instance& instance,
+        WarmStart& warm_start) const
+{
+    std::ifstream file(hash_path(instance));
+    if (!file.good()) {
+        file.clear();
+        file.open(dimensions_path(instance));
+        if (!file.good())
+            return false;
+    }
+
+    // Only keep the data which have the dimensions of the instance. A file
+    // which can't be parsed or whose values have unexpected types is a cache
+    // miss.
+    AgentIdx m = instance.number_of_agents();
+    ItemIdx n = instance.number_of_items();
+    WarmStart warm_start_new;
+    try {
+        nlohmann::json json;
+        file >> json;
+        auto read = [&json](
+                const std::string& key,
+                std::size_t size,
+                auto& values)
+        {
+            if (!json.contains(key))
+                return;
+            json[key].get_to(values);
+            if (values.size() != size)
+                values.clear();
+        };
+        read("LagrangianRelaxationKnapsackMultipliers", m, warm_start_new.lagrangian_relaxation_knapsack_multipliers);
+        read("LagrangianRelaxationAssignmentMultipliers", n, warm_start_new.lagrangian_relaxation_assignment_multipliers);
+        read("ColumnGenerationDuals", m + n, warm_start_new.column_generation_duals);
+        read("ItemsAgents", n, warm_start_new.items_agents);
+    } catch (const nlohmann::json::exception&) {
+        return false;
+    }
+    warm_start = warm_start_new;
+    return true;
+}
+
+void WarmStartCache::save(
+        const Instance& instance,
+        const WarmStart& warm_start) const
+{
+    nlohmann::json json = {
+        {"NumberOfAgents", instance.number_of_agents()},
+        {"NumberOfItems", instance.number_of_items()},
+        {"LagrangianRelaxationKnapsackMultipliers", warm_start.lagrangian_relaxation_knapsack_multipliers},
+        {"LagrangianRelaxationAssignmentMultipliers", warm_start.lagrangian_relaxation_assignment_multipliers},
+        {"ColumnGenerationDuals", warm_start.column_generation_duals},
+        {"ItemsAgents", warm_start.items_agents},
+    };
+    for (const std::string& path: {hash_path(instance), dimensions_path(instance)}) {
+        std::ofstream file(path);
+        if (!file.good()) {
+            throw std::runtime_error(
+                    "Unable to open file \"" + path + "\".");
+        }
+        file << json.dump() << std::endl;
+    }
+}